@@ -0,0 +1,107 @@
+<?php
+
+declare(strict_types=1);
+
+/**
+ * Wrapper dispatch micro-benchmark
+ *
+ * Measures the per-call overhead of the generated wrapper shapes against a raw
+ * $ffi->fn() call, using abs() from the C library already loaded by PHP.
+ *
+ * Usage: php bench/dispatch.php [iterations]
+ */
+
+if (!extension_loaded('ffi')) {
+    fwrite(STDERR, "Error: The FFI extension is required.\n");
+    exit(1);
+}
+
+$iterations = (int) ($argv[1] ?? 1000000);
+
+final class Bootstrap
+{
+    private static ?FFI $ffi = null;
+
+    public static function getFFI(): FFI
+    {
+        if (self::$ffi === null) {
+            self::$ffi = FFI::cdef('int abs(int j);');
+        }
+
+        return self::$ffi;
+    }
+}
+
+/**
+ * Default generated shape: static::getFFI() -> Bootstrap::getFFI() on every call
+ */
+final class ChainedMath
+{
+    protected static function getFFI(): FFI
+    {
+        return Bootstrap::getFFI();
+    }
+
+    public static function abs(int $j): int
+    {
+        return static::getFFI()->abs($j);
+    }
+}
+
+/**
+ * --direct-dispatch shape: the handle is bound once per class
+ */
+final class DirectMath
+{
+    private static ?FFI $ffi = null;
+
+    protected static function getFFI(): FFI
+    {
+        return Bootstrap::getFFI();
+    }
+
+    public static function abs(int $j): int
+    {
+        return (self::$ffi ??= static::getFFI())->abs($j);
+    }
+}
+
+$ffi = Bootstrap::getFFI();
+
+$cases = [
+    'raw $ffi->abs()' => static function (int $n) use ($ffi): void {
+        for ($i = 0; $i < $n; $i++) {
+            $ffi->abs(-$i);
+        }
+    },
+    'static::getFFI() chain' => static function (int $n): void {
+        for ($i = 0; $i < $n; $i++) {
+            ChainedMath::abs(-$i);
+        }
+    },
+    'direct dispatch' => static function (int $n): void {
+        for ($i = 0; $i < $n; $i++) {
+            DirectMath::abs(-$i);
+        }
+    },
+];
+
+// Warm up every path so lazy initialization is not measured
+foreach ($cases as $case) {
+    $case(1000);
+}
+
+$results = [];
+foreach ($cases as $name => $case) {
+    $start = hrtime(true);
+    $case($iterations);
+    $results[$name] = (hrtime(true) - $start) / $iterations;
+}
+
+$baseline = $results['raw $ffi->abs()'];
+
+printf("%d iterations\n\n", $iterations);
+printf("%-26s %12s %12s\n", 'Dispatch', 'ns/call', 'overhead');
+foreach ($results as $name => $nsPerCall) {
+    printf("%-26s %12.1f %11.1f%%\n", $name, $nsPerCall, ($nsPerCall / $baseline - 1) * 100);
+}
@@ -0,0 +1,36 @@
+#include <math.h>
+#include <string.h>
+
+#include "fixture.h"
+
+int fx_add(int a, int b)
+{
+    return a + b;
+}
+
+size_t fx_length(const char *text)
+{
+    return strlen(text);
+}
+
+double fx_norm(const fx_point *point)
+{
+    return sqrt(point->x * point->x + point->y * point->y);
+}
+
+int fx_apply(int (*callback)(int value), int value)
+{
+    return callback(value);
+}
+
+int fx_divmod(int dividend, int divisor, int *quotient, int *remainder)
+{
+    if (divisor == 0) {
+        return 0;
+    }
+
+    *quotient = dividend / divisor;
+    *remainder = dividend % divisor;
+
+    return 1;
+}
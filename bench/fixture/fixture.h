@@ -0,0 +1,28 @@
+#ifndef BENCH_FIXTURE_H
+#define BENCH_FIXTURE_H
+
+#include <stddef.h>
+
+/* Benchmark fixture: one function per call shape the wrappers generate */
+
+typedef struct fx_point {
+    double x;
+    double y;
+} fx_point;
+
+/* Scalar arguments and result */
+int fx_add(int a, int b);
+
+/* String argument */
+size_t fx_length(const char *text);
+
+/* Struct passed by pointer */
+double fx_norm(const fx_point *point);
+
+/* Function pointer argument */
+int fx_apply(int (*callback)(int value), int value);
+
+/* Scalar out-parameters */
+int fx_divmod(int dividend, int divisor, int *quotient, int *remainder);
+
+#endif
@@ -0,0 +1,170 @@
+<?php
+
+declare(strict_types=1);
+
+/**
+ * Header analysis scaling benchmark
+ *
+ * Writes synthetic amalgamation-style headers (export macros, doc comments,
+ * multi-line prototypes, structs, defines, inline function bodies) of
+ * growing size and runs HeaderAnalyzer over each. Fails when the time per
+ * line of the largest header exceeds that of the smallest by more than the
+ * tolerance, when the memory used by the lexer grows with the header size,
+ * or when a declaration is missing from the result.
+ *
+ * Usage: php bench/headers.php [--lines=N,N,...] [--iterations=N] [--tolerance=PCT]
+ */
+
+use Yangweijie\CWrapper\Analyzer\HeaderAnalyzer;
+use Yangweijie\CWrapper\Analyzer\HeaderLexer;
+
+require __DIR__ . '/../vendor/autoload.php';
+
+$options = getopt('', ['lines:', 'iterations:', 'tolerance:']);
+$sizes = array_map('intval', explode(',', $options['lines'] ?? '1000,10000,50000,100000'));
+$iterations = (int) ($options['iterations'] ?? 3);
+$tolerance = (float) ($options['tolerance'] ?? 50) / 100;
+
+$buildDir = __DIR__ . '/.build';
+if (!is_dir($buildDir) && !mkdir($buildDir, 0755, true)) {
+    fwrite(STDERR, "Error: Cannot create {$buildDir}\n");
+    exit(1);
+}
+
+/**
+ * Write a header of about $lines lines
+ *
+ * @return array{functions: int, structures: int, constants: int} Declarations written
+ */
+function writeHeader(string $file, int $lines): array
+{
+    $handle = fopen($file, 'wb');
+    $counts = ['functions' => 0, 'structures' => 0, 'constants' => 0];
+
+    fwrite($handle, "#ifndef BENCH_H\n#define BENCH_H\n#include <stddef.h>\n#ifdef __cplusplus\nextern \"C\" {\n#endif\n");
+    $written = 6;
+
+    for ($i = 0; $written < $lines; $i++) {
+        fwrite($handle, <<<C
+/*
+** Doc comment of bench_fn_{$i}(), mentioning int fake_{$i}(void); in prose.
+*/
+#define BENCH_LIMIT_{$i} {$i}
+typedef struct bench_rec_{$i} {
+  int id;
+  const char *name;
+  double weight;
+} bench_rec_{$i};
+BENCH_API const char *bench_fn_{$i}(
+  bench_rec_{$i} *rec,   /* record */
+  int (*callback)(void*, int),
+  size_t n
+);
+static inline int bench_inline_{$i}(int x) { return x + {$i}; }
+
+C);
+        $written += 15;
+        $counts['functions']++;
+        $counts['structures']++;
+        $counts['constants']++;
+    }
+
+    fwrite($handle, "#ifdef __cplusplus\n}\n#endif\n#endif\n");
+    fclose($handle);
+
+    return $counts;
+}
+
+/**
+ * Peak memory of tokenizing a file, above the memory in use before
+ */
+function lexerPeak(HeaderLexer $lexer, string $file): int
+{
+    if (function_exists('memory_reset_peak_usage')) {
+        memory_reset_peak_usage();
+    }
+    $before = memory_get_usage();
+
+    foreach ($lexer->tokenize($file) as $token) {
+        // Tokens are dropped as they are read
+    }
+
+    return memory_get_peak_usage() - $before;
+}
+
+$analyzer = new HeaderAnalyzer();
+$lexer = new HeaderLexer();
+$results = [];
+$failures = [];
+
+printf("%d iterations, PHP %s\n\n", $iterations, PHP_VERSION);
+printf("%-10s %12s %10s %12s %12s\n", 'Lines', 'Functions', 'ms', 'ns/line', 'lexer KB');
+
+foreach ($sizes as $lines) {
+    $file = "{$buildDir}/headers-{$lines}.h";
+    $expected = writeHeader($file, $lines);
+    $actualLines = count(file($file));
+
+    $times = [];
+    for ($i = 0; $i < $iterations; $i++) {
+        $start = hrtime(true);
+        $result = $analyzer->analyze($file);
+        $times[] = hrtime(true) - $start;
+    }
+    $peak = lexerPeak($lexer, $file);
+
+    sort($times);
+    $median = $times[intdiv(count($times), 2)];
+
+    $found = [
+        'functions' => count($result->functions),
+        'structures' => count($result->structures),
+        'constants' => count(array_filter(array_keys($result->constants), fn($name) => str_starts_with($name, 'BENCH_LIMIT_'))),
+    ];
+    foreach ($expected as $kind => $count) {
+        if ($found[$kind] !== $count) {
+            $failures[] = sprintf('%d lines: %d of %d %s found', $lines, $found[$kind], $count, $kind);
+        }
+    }
+
+    $results[$lines] = ['nsPerLine' => $median / $actualLines, 'peak' => $peak];
+    unset($result);
+
+    printf(
+        "%-10d %12d %10.1f %12.0f %12.2f\n",
+        $actualLines,
+        $found['functions'],
+        $median / 1e6,
+        $median / $actualLines,
+        $peak / 1024
+    );
+}
+
+$smallest = reset($results);
+$largest = end($results);
+
+if (count($results) > 1) {
+    if ($largest['nsPerLine'] > $smallest['nsPerLine'] * (1 + $tolerance)) {
+        $failures[] = sprintf(
+            'Time per line grew from %.0f ns to %.0f ns',
+            $smallest['nsPerLine'],
+            $largest['nsPerLine']
+        );
+    }
+
+    // The lexer holds at most two chunks whatever the header size
+    if ($largest['peak'] > $smallest['peak'] * 2 + 262144) {
+        $failures[] = sprintf(
+            'Lexer memory grew from %.0f KB to %.0f KB',
+            $smallest['peak'] / 1024,
+            $largest['peak'] / 1024
+        );
+    }
+}
+
+if (!empty($failures)) {
+    printf("\nFailures:\n  %s\n", implode("\n  ", $failures));
+    exit(1);
+}
+
+printf("\nLinear within %.0f%% tolerance\n", $tolerance * 100);
@@ -0,0 +1,254 @@
+<?php
+
+declare(strict_types=1);
+
+/**
+ * Runtime overhead benchmark suite
+ *
+ * Compiles bench/fixture with the local C compiler, generates release and
+ * debug wrappers for it through the regular generate command and measures
+ * every call shape (scalar, string, struct, callback, out-parameters) against
+ * the raw $ffi->fn() call and ValidationRuleEngine::validateFunctionParameters().
+ *
+ * Overheads are compared as ratios to the raw call of the same group, so the
+ * JSON baseline stays meaningful across machines. A ratio above the baseline
+ * by more than the tolerance fails the run, and so does a missing baseline.
+ *
+ * Usage: php bench/runtime.php [--revs=N] [--iterations=N] [--tolerance=PCT]
+ *                              [--baseline=FILE] [--update-baseline] [--json=FILE]
+ */
+
+use Symfony\Component\Console\Input\ArrayInput;
+use Symfony\Component\Console\Output\BufferedOutput;
+use Symfony\Component\Process\Process;
+use Yangweijie\CWrapper\Console\Application;
+use Yangweijie\CWrapper\Validation\ValidationRuleEngine;
+
+require __DIR__ . '/../vendor/autoload.php';
+
+if (!extension_loaded('ffi')) {
+    fwrite(STDERR, "Error: The FFI extension is required.\n");
+    exit(1);
+}
+
+$options = getopt('', ['revs:', 'iterations:', 'tolerance:', 'baseline:', 'update-baseline', 'json:']);
+$revs = (int) ($options['revs'] ?? 100000);
+$iterations = (int) ($options['iterations'] ?? 5);
+$tolerance = (float) ($options['tolerance'] ?? 15) / 100;
+$baselineFile = $options['baseline'] ?? __DIR__ . '/baselines.json';
+
+$fixtureDir = __DIR__ . '/fixture';
+$buildDir = __DIR__ . '/.build';
+$library = $buildDir . '/libfixture.' . PHP_SHLIB_SUFFIX;
+
+// Build the fixture library
+if (!is_dir($buildDir) && !mkdir($buildDir, 0755, true)) {
+    fwrite(STDERR, "Error: Cannot create {$buildDir}\n");
+    exit(1);
+}
+
+$compile = new Process([
+    getenv('CC') ?: 'cc', '-shared', '-fPIC', '-O2', '-o', $library, $fixtureDir . '/fixture.c', '-lm',
+]);
+$compile->run();
+
+if (!$compile->isSuccessful()) {
+    fwrite(STDERR, "Error: Failed to compile the fixture library:\n" . $compile->getErrorOutput());
+    exit(1);
+}
+
+// Generate the wrappers through the regular command pipeline
+$application = new Application();
+$application->setAutoExit(false);
+
+foreach (['release', 'debug'] as $profile) {
+    $output = new BufferedOutput();
+    $status = $application->run(new ArrayInput([
+        'command' => 'generate',
+        'header-files' => [$fixtureDir . '/fixture.h'],
+        '--output' => "{$buildDir}/{$profile}",
+        '--namespace' => 'Bench\\' . ucfirst($profile),
+        '--library' => $library,
+        '--type' => 'functional',
+        '--profile' => $profile,
+        '--out-params' => true,
+        '--force' => true,
+    ]), $output);
+
+    if ($status !== 0) {
+        fwrite(STDERR, "Error: Failed to generate the {$profile} wrappers:\n" . $output->fetch());
+        exit(1);
+    }
+}
+
+spl_autoload_register(static function (string $class) use ($buildDir): void {
+    if (preg_match('/^Bench\\\\(Release|Debug)\\\\(\w+)$/', $class, $matches)) {
+        $file = $buildDir . '/' . strtolower($matches[1]) . '/' . $matches[2] . '.php';
+        if (is_file($file)) {
+            require $file;
+        }
+    }
+});
+
+// --out-params must drop both int * out-pointers of fx_divmod from the wrappers
+foreach ([\Bench\Release\Functions::class, \Bench\Debug\Functions::class] as $class) {
+    $parameters = (new ReflectionMethod($class, 'fx_divmod'))->getNumberOfParameters();
+
+    if ($parameters !== 2) {
+        fwrite(STDERR, "Error: {$class}::fx_divmod() takes {$parameters} arguments, expected 2 with --out-params\n");
+        exit(1);
+    }
+}
+
+$ffi = \Bench\Release\Bootstrap::getFFI();
+$engine = new ValidationRuleEngine();
+
+$point = $ffi->new('fx_point');
+$point->x = 3.0;
+$point->y = 4.0;
+$pointer = FFI::addr($point);
+$increment = static fn(int $value): int => $value + 1;
+$text = 'The quick brown fox';
+
+// Each group lists its raw call first, the reference of the overhead ratios
+$groups = [
+    'scalar' => [
+        'raw' => static fn(int $i) => $ffi->fx_add($i, 1),
+        'wrapper' => static fn(int $i) => \Bench\Release\Functions::fx_add($i, 1),
+        'wrapper+validation' => static fn(int $i) => \Bench\Debug\Functions::fx_add($i, 1),
+        'rule engine+raw' => static fn(int $i) => $engine->validateFunctionParameters([$i, 1], ['int', 'int'])->isValid
+            && $ffi->fx_add($i, 1),
+    ],
+    'string' => [
+        'raw' => static fn(int $i) => $ffi->fx_length($text),
+        'wrapper' => static fn(int $i) => \Bench\Release\Functions::fx_length($text),
+        'wrapper+validation' => static fn(int $i) => \Bench\Debug\Functions::fx_length($text),
+        'rule engine+raw' => static fn(int $i) => $engine->validateFunctionParameters([$text], ['const char*'])->isValid
+            && $ffi->fx_length($text),
+    ],
+    'struct' => [
+        'raw' => static fn(int $i) => $ffi->fx_norm($pointer),
+        'wrapper' => static fn(int $i) => \Bench\Release\Functions::fx_norm($pointer),
+        'wrapper+validation' => static fn(int $i) => \Bench\Debug\Functions::fx_norm($pointer),
+    ],
+    'callback' => [
+        // A raw closure argument creates a new trampoline per call, kept until the end of the request
+        'raw' => static fn(int $i) => $ffi->fx_apply($increment, $i),
+        'wrapper' => static fn(int $i) => \Bench\Release\Functions::fx_apply($increment, $i),
+        'wrapper+validation' => static fn(int $i) => \Bench\Debug\Functions::fx_apply($increment, $i),
+    ],
+    'out-param' => [
+        'raw' => static function (int $i) use ($ffi): array {
+            $quotient = $ffi->new('int');
+            $remainder = $ffi->new('int');
+            $ok = $ffi->fx_divmod($i, 7, FFI::addr($quotient), FFI::addr($remainder));
+
+            return [$ok, $quotient->cdata, $remainder->cdata];
+        },
+        'wrapper' => static fn(int $i) => \Bench\Release\Functions::fx_divmod($i, 7),
+        'wrapper+validation' => static fn(int $i) => \Bench\Debug\Functions::fx_divmod($i, 7),
+    ],
+];
+
+/**
+ * Measure one case: ns per call of every iteration of $revs calls
+ *
+ * @return array<float>
+ */
+function measure(Closure $case, int $revs, int $iterations): array
+{
+    // Warm up so lazy initialization is not measured
+    for ($i = 0; $i < 1000; $i++) {
+        $case($i);
+    }
+
+    $samples = [];
+    for ($iteration = 0; $iteration < $iterations; $iteration++) {
+        $start = hrtime(true);
+        for ($i = 0; $i < $revs; $i++) {
+            $case($i);
+        }
+        $samples[] = (hrtime(true) - $start) / $revs;
+    }
+
+    return $samples;
+}
+
+function median(array $values): float
+{
+    sort($values);
+    $middle = intdiv(count($values), 2);
+
+    return count($values) % 2 ? $values[$middle] : ($values[$middle - 1] + $values[$middle]) / 2;
+}
+
+function rstdev(array $values): float
+{
+    $mean = array_sum($values) / count($values);
+    $variance = array_sum(array_map(fn($value) => ($value - $mean) ** 2, $values)) / count($values);
+
+    return $mean > 0 ? sqrt($variance) / $mean * 100 : 0.0;
+}
+
+$baseline = is_file($baselineFile) ? json_decode(file_get_contents($baselineFile), true)['ratios'] ?? [] : [];
+$results = [];
+$regressions = [];
+
+printf("%d revs x %d iterations, PHP %s\n\n", $revs, $iterations, PHP_VERSION);
+printf("%-30s %10s %9s %9s %10s\n", 'Case', 'ns/call', 'rstdev', 'ratio', 'baseline');
+
+foreach ($groups as $group => $cases) {
+    $reference = null;
+
+    foreach ($cases as $name => $case) {
+        // Callback trampolines of the raw case are only released at the end of the request
+        $caseRevs = $group === 'callback' ? max(1, intdiv($revs, 10)) : $revs;
+        $samples = measure($case, $caseRevs, $iterations);
+        $nsPerCall = median($samples);
+        $reference ??= $nsPerCall;
+
+        $id = "{$group}/{$name}";
+        $ratio = $nsPerCall / $reference;
+        $expected = $baseline[$id] ?? null;
+
+        $results[$id] = ['nsPerCall' => $nsPerCall, 'rstdev' => rstdev($samples), 'ratio' => $ratio];
+
+        if ($expected !== null && $ratio > $expected * (1 + $tolerance)) {
+            $regressions[] = sprintf('%s: ratio %.2f, baseline %.2f', $id, $ratio, $expected);
+        }
+
+        printf(
+            "%-30s %10.1f %8.1f%% %9.2f %10s\n",
+            $id,
+            $nsPerCall,
+            $results[$id]['rstdev'],
+            $ratio,
+            $expected !== null ? sprintf('%.2f', $expected) : '-'
+        );
+    }
+}
+
+if (isset($options['json'])) {
+    file_put_contents($options['json'], json_encode($results, JSON_PRETTY_PRINT) . "\n");
+}
+
+if (isset($options['update-baseline'])) {
+    file_put_contents($baselineFile, json_encode([
+        'php' => PHP_VERSION,
+        'ratios' => array_map(fn($result) => round($result['ratio'], 2), $results),
+    ], JSON_PRETTY_PRINT) . "\n");
+    printf("\nBaseline written to %s\n", $baselineFile);
+    exit(0);
+}
+
+if (empty($baseline)) {
+    fwrite(STDERR, sprintf("\nError: No baseline found at %s, record one with composer bench:baseline\n", $baselineFile));
+    exit(1);
+}
+
+if (!empty($regressions)) {
+    printf("\nRegressions above %.0f%% tolerance:\n  %s\n", $tolerance * 100, implode("\n  ", $regressions));
+    exit(1);
+}
+
+printf("\nNo regression above %.0f%% tolerance\n", $tolerance * 100);
\ No newline at end of file
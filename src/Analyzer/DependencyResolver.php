@@ -8,6 +8,11 @@ use Yangweijie\CWrapper\Exception\AnalysisException;
 
 /**
  * Resolves header file dependencies and creates compilation order
+ *
+ * Visited files and dependencies are kept in keyed sets, and include
+ * resolutions are memoized per run and persisted through IncludeCache, so
+ * a warm run over an unchanged tree reads no header and probes no path.
+ * Headers that do need reading come from the shared SourceFileRepository.
  */
 class DependencyResolver
 {
@@ -17,16 +22,32 @@ class DependencyResolver
     /** @var array<string, array<string>> */
     private array $dependencyCache = [];
 
+    /** @var array<string, string|null> */
+    private array $resolutionCache = [];
+
+    /** @var array<string>|null */
+    private ?array $realSystemIncludePaths = null;
+
+    private IncludeCache $includeCache;
+    private SourceFileRepository $sources;
+
     /**
      * @param array<string> $systemIncludePaths System header file locations
+     * @param IncludeCache|null $includeCache Persistent include cache, shared through the temp directory by default
+     * @param SourceFileRepository|null $sources Header contents shared with later stages
      */
-    public function __construct(array $systemIncludePaths = [])
-    {
+    public function __construct(
+        array $systemIncludePaths = [],
+        ?IncludeCache $includeCache = null,
+        ?SourceFileRepository $sources = null
+    ) {
         $this->systemIncludePaths = array_merge([
             '/usr/include',
             '/usr/local/include',
             '/opt/homebrew/include', // macOS Homebrew
         ], $systemIncludePaths);
+        $this->includeCache = $includeCache ?? new IncludeCache();
+        $this->sources = $sources ?? new SourceFileRepository();
     }
 
     /**
@@ -39,16 +60,9 @@ class DependencyResolver
      */
     public function resolveDependencies(string $headerPath, array $searchPaths = []): array
     {
-        if (isset($this->dependencyCache[$headerPath])) {
-            return $this->dependencyCache[$headerPath];
-        }
+        $dependencies = $this->collectDependencies($headerPath, $searchPaths);
+        $this->includeCache->save();
 
-        $dependencies = [];
-        $visited = [];
-        
-        $this->resolveDependenciesRecursive($headerPath, $searchPaths, $dependencies, $visited);
-        
-        $this->dependencyCache[$headerPath] = $dependencies;
         return $dependencies;
     }
 
@@ -76,16 +90,43 @@ class DependencyResolver
         
         // Build dependency graph for all headers
         foreach ($normalizedHeaderPaths as $headerPath) {
-            $dependencies = $this->resolveDependencies($headerPath, $searchPaths);
+            $dependencies = $this->collectDependencies($headerPath, $searchPaths);
             $dependencyGraph[$headerPath] = $dependencies;
-            $allHeaders[] = $headerPath;
-            $allHeaders = array_merge($allHeaders, $dependencies);
+            $allHeaders[$headerPath] = true;
+
+            foreach ($dependencies as $dependency) {
+                $allHeaders[$dependency] = true;
+            }
         }
         
-        $allHeaders = array_unique($allHeaders);
+        $this->includeCache->save();
         
         // Perform topological sort
-        return $this->topologicalSort($dependencyGraph, $allHeaders);
+        return $this->topologicalSort($dependencyGraph, array_keys($allHeaders));
+    }
+
+    /**
+     * Resolve dependencies for a header file without saving the include cache
+     *
+     * @param string $headerPath Path to the header file
+     * @param array<string> $searchPaths Additional search paths for includes
+     * @return array<string> List of dependency file paths
+     * @throws AnalysisException If dependencies cannot be resolved
+     */
+    private function collectDependencies(string $headerPath, array $searchPaths): array
+    {
+        $cacheKey = $headerPath . "\0" . implode("\0", $searchPaths);
+
+        if (isset($this->dependencyCache[$cacheKey])) {
+            return $this->dependencyCache[$cacheKey];
+        }
+
+        $dependencies = [];
+        $visited = [];
+        
+        $this->resolveDependenciesRecursive($headerPath, $searchPaths, $dependencies, $visited);
+        
+        return $this->dependencyCache[$cacheKey] = array_keys($dependencies);
     }
 
     /**
@@ -93,8 +134,8 @@ class DependencyResolver
      *
      * @param string $headerPath Current header file path
      * @param array<string> $searchPaths Search paths for includes
-     * @param array<string> $dependencies Accumulated dependencies
-     * @param array<string> $visited Visited files to detect cycles
+     * @param array<string, true> $dependencies Accumulated dependencies
+     * @param array<string, true> $visited Visited files to detect cycles
      */
     private function resolveDependenciesRecursive(
         string $headerPath,
@@ -107,25 +148,19 @@ class DependencyResolver
             throw new AnalysisException("Header file not found: {$headerPath}");
         }
         
-        if (in_array($realPath, $visited)) {
+        if (isset($visited[$realPath])) {
             // Circular dependency detected - skip to avoid infinite loop
             return;
         }
         
-        $visited[] = $realPath;
-        
-        $content = file_get_contents($realPath);
-        if ($content === false) {
-            throw new AnalysisException("Failed to read header file: {$headerPath}");
-        }
-        
-        $includes = $this->extractIncludes($content);
+        $visited[$realPath] = true;
+        $currentDir = dirname($realPath);
         
-        foreach ($includes as $include) {
-            $includePath = $this->resolveIncludePath($include, dirname($realPath), $searchPaths);
+        foreach ($this->getIncludes($realPath) as $include) {
+            $includePath = $this->resolveIncludePath($include, $currentDir, $searchPaths);
             
-            if ($includePath && !in_array($includePath, $dependencies)) {
-                $dependencies[] = $includePath;
+            if ($includePath !== null && !isset($dependencies[$includePath])) {
+                $dependencies[$includePath] = true;
                 
                 // Recursively resolve dependencies of the included file
                 $this->resolveDependenciesRecursive($includePath, $searchPaths, $dependencies, $visited);
@@ -133,31 +168,35 @@ class DependencyResolver
         }
         
         // Remove current file from visited to allow it in other dependency chains
-        array_pop($visited);
+        unset($visited[$realPath]);
     }
 
     /**
-     * Extract include statements from header content
+     * Get the include statements of a header, read only when it changed
      *
+     * @param string $realPath Resolved header path
      * @return array<string>
+     * @throws AnalysisException If the header cannot be read
      */
-    private function extractIncludes(string $content): array
+    private function getIncludes(string $realPath): array
     {
-        $includes = [];
-        
-        // Pattern to match #include statements
-        $pattern = '/#include\s+[<"]([^>"]+)[>"]/';
-        
-        if (preg_match_all($pattern, $content, $matches)) {
-            $includes = $matches[1];
+        $includes = $this->includeCache->getIncludes($realPath);
+        if ($includes !== null) {
+            return $includes;
         }
-        
+
+        $includes = $this->sources->get($realPath)->getIncludes();
+        $this->includeCache->setIncludes($realPath, $includes);
+
         return $includes;
     }
 
     /**
      * Resolve the full path for an include statement
      *
+     * Memoized for the run and persisted with the mtimes of the directories
+     * probed, which change when a candidate file appears or disappears.
+     *
      * @param string $include Include filename (e.g., "stdio.h" or "myheader.h")
      * @param string $currentDir Directory of the current header file
      * @param array<string> $searchPaths Additional search paths
@@ -165,30 +204,35 @@ class DependencyResolver
      */
     private function resolveIncludePath(string $include, string $currentDir, array $searchPaths): ?string
     {
-        // First, try relative to current directory
-        $relativePath = $currentDir . DIRECTORY_SEPARATOR . $include;
-        if (file_exists($relativePath)) {
-            return realpath($relativePath);
+        $key = $include . "\0" . $currentDir . "\0" . implode("\0", $searchPaths);
+
+        if (array_key_exists($key, $this->resolutionCache)) {
+            return $this->resolutionCache[$key];
         }
-        
-        // Try additional search paths
-        foreach ($searchPaths as $searchPath) {
-            $fullPath = $searchPath . DIRECTORY_SEPARATOR . $include;
-            if (file_exists($fullPath)) {
-                return realpath($fullPath);
-            }
+
+        $cached = $this->includeCache->getResolution($key);
+        if ($cached !== null) {
+            return $this->resolutionCache[$key] = $cached['path'];
         }
-        
-        // Try system include paths
-        foreach ($this->systemIncludePaths as $systemPath) {
-            $fullPath = $systemPath . DIRECTORY_SEPARATOR . $include;
+
+        // Current directory first, then additional search paths, then system include paths
+        $probed = [];
+        $resolved = null;
+
+        foreach (array_merge([$currentDir], $searchPaths, $this->systemIncludePaths) as $directory) {
+            $fullPath = $directory . DIRECTORY_SEPARATOR . $include;
+            $probed[] = dirname($fullPath);
+
             if (file_exists($fullPath)) {
-                return realpath($fullPath);
+                $resolved = realpath($fullPath) ?: null;
+                break;
             }
         }
         
-        // Include not found - this might be a system header we don't need to analyze
-        return null;
+        // Unresolved includes are usually system headers we don't need to analyze
+        $this->includeCache->setResolution($key, $resolved, array_unique($probed));
+
+        return $this->resolutionCache[$key] = $resolved;
     }
 
     /**
@@ -206,7 +250,7 @@ class DependencyResolver
         $visiting = [];
         
         foreach ($allHeaders as $header) {
-            if (!in_array($header, $visited)) {
+            if (!isset($visited[$header])) {
                 $this->topologicalSortVisit($header, $dependencyGraph, $sorted, $visited, $visiting);
             }
         }
@@ -220,8 +264,8 @@ class DependencyResolver
      * @param string $header Current header
      * @param array<string, array<string>> $dependencyGraph
      * @param array<string> $sorted
-     * @param array<string> $visited
-     * @param array<string> $visiting
+     * @param array<string, true> $visited
+     * @param array<string, true> $visiting
      * @throws AnalysisException If circular dependency is detected
      */
     private function topologicalSortVisit(
@@ -231,15 +275,15 @@ class DependencyResolver
         array &$visited,
         array &$visiting
     ): void {
-        if (in_array($header, $visiting)) {
+        if (isset($visiting[$header])) {
             throw new AnalysisException("Circular dependency detected involving: {$header}");
         }
         
-        if (in_array($header, $visited)) {
+        if (isset($visited[$header])) {
             return;
         }
         
-        $visiting[] = $header;
+        $visiting[$header] = true;
         
         $dependencies = $dependencyGraph[$header] ?? [];
         foreach ($dependencies as $dependency) {
@@ -247,15 +291,33 @@ class DependencyResolver
         }
         
         // Remove from visiting and add to visited
-        $visitingIndex = array_search($header, $visiting);
-        if ($visitingIndex !== false) {
-            array_splice($visiting, $visitingIndex, 1);
-        }
+        unset($visiting[$header]);
         
-        $visited[] = $header;
+        $visited[$header] = true;
         $sorted[] = $header;
     }
 
+    /**
+     * Check whether a header lives in one of the system include paths
+     *
+     * @param string $headerPath Header file path
+     * @return bool True for system headers
+     */
+    public function isSystemHeader(string $headerPath): bool
+    {
+        $realPath = realpath($headerPath) ?: $headerPath;
+
+        $this->realSystemIncludePaths ??= array_values(array_filter(array_map('realpath', $this->systemIncludePaths)));
+
+        foreach ($this->realSystemIncludePaths as $systemPath) {
+            if (str_starts_with($realPath, $systemPath . DIRECTORY_SEPARATOR)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     /**
      * Get dependency graph for a set of headers
      *
@@ -268,10 +330,12 @@ class DependencyResolver
         $graph = [];
         
         foreach ($headerPaths as $headerPath) {
-            $dependencies = $this->resolveDependencies($headerPath, $searchPaths);
+            $dependencies = $this->collectDependencies($headerPath, $searchPaths);
             $graph[$headerPath] = $dependencies;
         }
         
+        $this->includeCache->save();
+        
         return $graph;
     }
 }
\ No newline at end of file
@@ -11,9 +11,53 @@ use Yangweijie\CWrapper\Exception\AnalysisException;
  */
 class HeaderAnalyzer implements AnalyzerInterface
 {
+    /**
+     * Specifiers that are not part of a function's return type
+     */
+    private const STORAGE_SPECIFIERS = ['extern', 'static', 'inline', '__inline', '__inline__', '__extension__'];
+
+    /**
+     * Compiler extensions taking a parenthesized argument, ignored in declarations
+     */
+    private const ATTRIBUTE_KEYWORDS = ['__attribute__', '__attribute', '__declspec', '__asm__', '__asm', 'asm'];
+
+    private HeaderLexer $lexer;
+    private ?HeaderPreprocessor $preprocessor;
+    private ?SourceFileRepository $sources;
+
+    /**
+     * @param HeaderLexer|null $lexer Tokenizer
+     * @param HeaderPreprocessor|null $preprocessor Expand headers with the C preprocessor before analysis
+     * @param SourceFileRepository|null $sources Analyze the shared header contents instead of streaming each file
+     */
+    public function __construct(
+        ?HeaderLexer $lexer = null,
+        ?HeaderPreprocessor $preprocessor = null,
+        ?SourceFileRepository $sources = null
+    ) {
+        $this->lexer = $lexer ?? new HeaderLexer();
+        $this->preprocessor = $preprocessor;
+        $this->sources = $sources;
+    }
+
+    /**
+     * Check whether headers are analyzed as expanded by the C preprocessor
+     */
+    public function isPreprocessing(): bool
+    {
+        return $this->preprocessor !== null;
+    }
+
     /**
      * Analyze a C header file
      *
+     * Streams the header through HeaderLexer and collects declarations one
+     * top-level statement at a time, so time is linear and memory bounded by
+     * the largest declaration rather than the size of the header. With a
+     * source repository, the content other stages already loaded is
+     * tokenized instead of reading the file again. With a preprocessor, the
+     * cached expansion of the header is analyzed instead.
+     *
      * @param string $path Path to the header file
      * @return AnalysisResult Analysis results
      * @throws AnalysisException If the file cannot be analyzed
@@ -28,71 +72,320 @@ class HeaderAnalyzer implements AnalyzerInterface
             throw new AnalysisException("Header file is not readable: {$path}");
         }
 
-        $content = file_get_contents($path);
-        if ($content === false) {
-            throw new AnalysisException("Failed to read header file: {$path}");
+        if ($this->preprocessor !== null) {
+            return $this->analyzeExpanded($this->preprocessor->preprocess($path)['output']);
         }
 
-        // Remove comments and preprocess content
-        $cleanContent = $this->preprocessContent($content);
-
-        // Extract different elements
-        $functions = $this->extractFunctions($cleanContent);
-        $structures = $this->extractStructures($cleanContent);
-        $constants = $this->extractConstants($content); // Use original content for constants
-        $dependencies = $this->extractDependencies($content); // Use original content for includes
+        $tokens = $this->sources !== null
+            ? $this->lexer->tokenizeString($this->sources->get($path)->content)
+            : $this->lexer->tokenize($path);
 
-        return new AnalysisResult($functions, $structures, $constants, $dependencies);
+        return $this->analyzeTokens($tokens, false);
     }
 
     /**
-     * Preprocess content by removing comments and normalizing whitespace
+     * Analyze the output of `cpp -E -dD`
+     *
+     * Line markers tell which file each declaration comes from; only
+     * declarations and defines of project files are kept, those of system
+     * headers, built-in and command-line macros are skipped. Dependencies
+     * are the files the preprocessor actually included.
+     *
+     * @param string $path Path to the preprocessed file
+     * @return AnalysisResult Analysis results
+     * @throws AnalysisException If the file cannot be analyzed
      */
-    private function preprocessContent(string $content): string
+    public function analyzeExpanded(string $path): AnalysisResult
     {
-        // Remove single-line comments
-        $content = preg_replace('/\/\/.*$/m', '', $content);
-        
-        // Remove multi-line comments
-        $content = preg_replace('/\/\*.*?\*\//s', '', $content);
-        
-        // Normalize whitespace
-        $content = preg_replace('/\s+/', ' ', $content);
-        
-        return trim($content);
+        if (!is_readable($path)) {
+            throw new AnalysisException("Preprocessed header is not readable: {$path}");
+        }
+
+        return $this->analyzeTokens($this->lexer->tokenize($path), true);
     }
 
     /**
-     * Extract function signatures from header content
+     * Collect the declarations of a header or preprocessed file
      *
-     * @return array<FunctionSignature>
+     * @param \Generator<int, array{int, string, bool}> $tokens Tokens of the file
+     * @param bool $expanded Whether the file is preprocessor output with line markers
+     * @return AnalysisResult Analysis results
+     * @throws AnalysisException If the file cannot be read
      */
-    private function extractFunctions(string $content): array
+    private function analyzeTokens(\Generator $tokens, bool $expanded): AnalysisResult
     {
         $functions = [];
-        
-        // Pattern to match function declarations
-        // Matches: return_type function_name(parameters);
-        // Updated to handle function pointers in parameters
-        $pattern = '/(\w+(?:\s*\*)*)\s+(\w+)\s*\(([^;]*?)\)\s*;/';
-        
-        if (preg_match_all($pattern, $content, $matches, PREG_SET_ORDER)) {
-            foreach ($matches as $match) {
-                $returnType = trim($match[1]);
-                $functionName = trim($match[2]);
-                $parametersStr = trim($match[3]);
-                
-                $parameters = $this->parseParameters($parametersStr);
-                
-                $functions[] = new FunctionSignature(
-                    $functionName,
-                    $returnType,
-                    $parameters
-                );
+        $structures = [];
+        $constants = [];
+        $dependencies = [];
+
+        $statement = [];
+        $depth = 0;
+        $externBlocks = 0;
+        $skipBody = false;
+        $mainFile = null;
+        $projectFile = true;
+
+        foreach ($tokens as $token) {
+            [$kind, $text] = $token;
+
+            if ($kind === HeaderLexer::DIRECTIVE) {
+                if ($expanded && preg_match('/^(?:line\s+)?\d+\s+"((?:[^"\\\\]|\\\\.)*)"(.*)$/', $text, $marker)) {
+                    // Flag 3 marks a system header, <built-in> and <command-line> are no files
+                    $file = stripcslashes($marker[1]);
+                    $projectFile = !str_starts_with($file, '<') && !preg_match('/\s3\b/', $marker[2]);
+                    $mainFile ??= str_starts_with($file, '<') ? null : $file;
+
+                    if (!str_starts_with($file, '<') && $file !== $mainFile) {
+                        $dependencies[$file] = true;
+                    }
+                } elseif ($projectFile) {
+                    $this->analyzeDirective($text, $constants, $dependencies);
+                }
+                continue;
+            }
+
+            if ($kind === HeaderLexer::PUNCTUATOR && $text === '{') {
+                // extern "C" { only wraps declarations
+                if ($depth === 0 && count($statement) === 2
+                    && $statement[0][1] === 'extern' && $statement[1][0] === HeaderLexer::STRING) {
+                    $externBlocks++;
+                    $statement = [];
+                    continue;
+                }
+
+                // Function bodies are skipped instead of buffered
+                if ($depth === 0 && $statement !== [] && $statement[count($statement) - 1][1] === ')') {
+                    $skipBody = true;
+                }
+
+                $depth++;
+            } elseif ($kind === HeaderLexer::PUNCTUATOR && $text === '}') {
+                if ($depth === 0) {
+                    $externBlocks = max(0, $externBlocks - 1);
+                    $statement = [];
+                    continue;
+                }
+
+                $depth--;
+
+                if ($depth === 0 && $skipBody) {
+                    $skipBody = false;
+                    $statement = [];
+                    continue;
+                }
+            } elseif ($kind === HeaderLexer::PUNCTUATOR && $text === ';' && $depth === 0) {
+                if ($projectFile) {
+                    $this->analyzeStatement($statement, $functions, $structures);
+                }
+                $statement = [];
+                continue;
+            }
+
+            if (!$skipBody) {
+                $statement[] = $token;
             }
         }
-        
-        return $functions;
+
+        return new AnalysisResult($functions, $structures, $constants, array_keys($dependencies));
+    }
+
+    /**
+     * Collect a #define constant or an #include dependency
+     *
+     * @param string $directive Directive without the leading #
+     * @param array<string, mixed> $constants Constants found so far
+     * @param array<string, true> $dependencies Included headers found so far
+     */
+    private function analyzeDirective(string $directive, array &$constants, array &$dependencies): void
+    {
+        // Only defines with a value, header guards and function-like macros are skipped
+        if (preg_match('/^define\s+(\w+)\s+(.+)$/', $directive, $matches)) {
+            $value = trim($matches[2]);
+
+            if ($value !== '' && $value !== $matches[1]) {
+                $constants[$matches[1]] = $this->parseConstantValue($value);
+            }
+        } elseif (preg_match('/^include\s*[<"]([^>"]+)[>"]/', $directive, $matches)) {
+            $dependencies[$matches[1]] = true;
+        }
+    }
+
+    /**
+     * Collect the function or structure declared by a top-level statement
+     *
+     * @param array<array{int, string, bool}> $tokens Statement tokens without the closing semicolon
+     * @param array<FunctionSignature> $functions Functions found so far
+     * @param array<StructureDefinition> $structures Structures found so far
+     */
+    private function analyzeStatement(array $tokens, array &$functions, array &$structures): void
+    {
+        if ($tokens === []) {
+            return;
+        }
+
+        if ($tokens[0][1] === 'typedef') {
+            $structure = $this->parseTypedefStructure($tokens);
+            if ($structure !== null) {
+                $structures[] = $structure;
+            }
+            return;
+        }
+
+        $function = $this->parseFunctionDeclaration($tokens);
+        if ($function !== null) {
+            $functions[] = $function;
+        }
+    }
+
+    /**
+     * Parse a declaration like "const char *name(int a, int b)"
+     *
+     * @param array<array{int, string, bool}> $tokens Statement tokens
+     * @return FunctionSignature|null Function signature, null if the statement declares no function
+     */
+    private function parseFunctionDeclaration(array $tokens): ?FunctionSignature
+    {
+        $tokens = $this->stripAttributes($tokens);
+        $count = count($tokens);
+
+        $open = 1;
+        while ($open < $count && $tokens[$open][1] !== '(') {
+            $open++;
+        }
+
+        if ($open >= $count || $tokens[$open - 1][0] !== HeaderLexer::IDENTIFIER) {
+            return null;
+        }
+
+        $level = 0;
+        for ($close = $open; $close < $count; $close++) {
+            if ($tokens[$close][1] === '(') {
+                $level++;
+            } elseif ($tokens[$close][1] === ')' && --$level === 0) {
+                break;
+            }
+        }
+
+        // Only attribute macros may follow the parameter list
+        if ($close >= $count || ($close + 1 < $count && $tokens[$close + 1][0] !== HeaderLexer::IDENTIFIER)) {
+            return null;
+        }
+
+        $typeTokens = array_slice($tokens, 0, $open - 1);
+        foreach ($typeTokens as [$kind, $text]) {
+            if ($kind !== HeaderLexer::IDENTIFIER && $text !== '*') {
+                return null;
+            }
+        }
+
+        // Drop storage specifiers and export macros like SQLITE_API in front of the type
+        while (count($typeTokens) > 1
+            && (in_array($typeTokens[0][1], self::STORAGE_SPECIFIERS, true)
+                || (preg_match('/^[A-Z][A-Z0-9_]*$/', $typeTokens[0][1]) && $typeTokens[1][0] === HeaderLexer::IDENTIFIER))) {
+            array_shift($typeTokens);
+        }
+
+        if ($typeTokens === [] || in_array($typeTokens[0][1], self::STORAGE_SPECIFIERS, true)) {
+            return null;
+        }
+
+        return new FunctionSignature(
+            $tokens[$open - 1][1],
+            $this->render($typeTokens),
+            $this->parseParameters($this->render(array_slice($tokens, $open + 1, $close - $open - 1)))
+        );
+    }
+
+    /**
+     * Parse a declaration like "typedef struct [tag] { fields } Name"
+     *
+     * @param array<array{int, string, bool}> $tokens Statement tokens
+     * @return StructureDefinition|null Structure definition, null for other typedefs
+     */
+    private function parseTypedefStructure(array $tokens): ?StructureDefinition
+    {
+        $count = count($tokens);
+
+        if ($count < 5 || !in_array($tokens[1][1], ['struct', 'union'], true)) {
+            return null;
+        }
+
+        $open = $tokens[2][1] === '{' ? 2 : ($tokens[3][1] === '{' && $tokens[2][0] === HeaderLexer::IDENTIFIER ? 3 : null);
+        $close = $count - 2;
+
+        if ($open === null || $tokens[$close][1] !== '}' || $tokens[$count - 1][0] !== HeaderLexer::IDENTIFIER) {
+            return null;
+        }
+
+        $body = array_slice($tokens, $open + 1, $close - $open - 1);
+
+        // Nested structures are not described field by field
+        foreach ($body as [, $text]) {
+            if ($text === '{') {
+                return null;
+            }
+        }
+
+        // The typedef name is a valid C type whether or not the structure has a tag
+        return new StructureDefinition(
+            $tokens[$count - 1][1],
+            $this->parseStructFields($this->render($body)),
+            $tokens[1][1] === 'union',
+            $open === 3 ? $tokens[2][1] : null,
+            $tokens[$count - 1][1]
+        );
+    }
+
+    /**
+     * Remove __attribute__((...)) and similar extensions from a statement
+     *
+     * @param array<array{int, string, bool}> $tokens Statement tokens
+     * @return array<array{int, string, bool}> Tokens without extensions
+     */
+    private function stripAttributes(array $tokens): array
+    {
+        $result = [];
+        $count = count($tokens);
+
+        for ($i = 0; $i < $count; $i++) {
+            if (!in_array($tokens[$i][1], self::ATTRIBUTE_KEYWORDS, true)) {
+                $result[] = $tokens[$i];
+                continue;
+            }
+
+            // Skip the keyword and its balanced argument list
+            $level = 0;
+            while ($i + 1 < $count) {
+                $text = $tokens[++$i][1];
+                if ($text === '(') {
+                    $level++;
+                } elseif ($text === ')' && --$level <= 0) {
+                    break;
+                } elseif ($level === 0) {
+                    $i--;
+                    break;
+                }
+            }
+        }
+
+        return $result;
+    }
+
+    /**
+     * Rebuild source text from tokens with whitespace collapsed
+     *
+     * @param array<array{int, string, bool}> $tokens Tokens
+     */
+    private function render(array $tokens): string
+    {
+        $text = '';
+
+        foreach ($tokens as $index => [, $value, $space]) {
+            $text .= ($space && $index > 0 ? ' ' : '') . $value;
+        }
+
+        return $text;
     }
 
     /**
@@ -129,7 +422,14 @@ class HeaderAnalyzer implements AnalyzerInterface
                     'type' => $type
                 ];
             }
-            // Handle regular parameters like "int a", "int* arr", "const char* str"
+            // Handle pointer parameters like "int *out", "int * out", "int* out", "const char **argv"
+            else if (preg_match('/^(.+?)\s*(\*+)\s*(\w+)$/', $param, $matches)) {
+                $parameters[] = [
+                    'name' => $matches[3],
+                    'type' => trim($matches[1]) . ' ' . $matches[2]
+                ];
+            }
+            // Handle regular parameters like "int a", "unsigned long size"
             else if (preg_match('/^(.+?)\s+(\w+)$/', $param, $matches)) {
                 $type = trim($matches[1]);
                 $name = trim($matches[2]);
@@ -184,38 +484,6 @@ class HeaderAnalyzer implements AnalyzerInterface
         return $parts;
     }
 
-    /**
-     * Extract structure definitions from header content
-     *
-     * @return array<StructureDefinition>
-     */
-    private function extractStructures(string $content): array
-    {
-        $structures = [];
-        
-        // Pattern to match typedef struct definitions
-        $pattern = '/typedef\s+(struct|union)\s*\{([^}]+)\}\s*(\w+)\s*;/';
-        
-        if (preg_match_all($pattern, $content, $matches, PREG_SET_ORDER)) {
-            foreach ($matches as $match) {
-                $type = $match[1]; // 'struct' or 'union'
-                $fieldsStr = $match[2];
-                $structName = $match[3];
-                
-                $fields = $this->parseStructFields($fieldsStr);
-                $isUnion = ($type === 'union');
-                
-                $structures[] = new StructureDefinition(
-                    $structName,
-                    $fields,
-                    $isUnion
-                );
-            }
-        }
-        
-        return $structures;
-    }
-
     /**
      * Parse structure fields string into structured format
      *
@@ -234,8 +502,15 @@ class HeaderAnalyzer implements AnalyzerInterface
                 continue;
             }
             
-            // Parse field declaration like "int x" or "char* name"
-            if (preg_match('/^(.+?)\s+(\w+)$/', $declaration, $matches)) {
+            // Parse pointer field declarations like "char *name" or "char* name"
+            if (preg_match('/^(.+?)\s*(\*+)\s*(\w+)$/', $declaration, $matches)) {
+                $fields[] = [
+                    'name' => $matches[3],
+                    'type' => trim($matches[1]) . ' ' . $matches[2]
+                ];
+            }
+            // Parse field declaration like "int x"
+            elseif (preg_match('/^(.+?)\s+(\w+)$/', $declaration, $matches)) {
                 $type = trim($matches[1]);
                 $name = trim($matches[2]);
                 
@@ -249,39 +524,6 @@ class HeaderAnalyzer implements AnalyzerInterface
         return $fields;
     }
 
-    /**
-     * Extract constants and preprocessor definitions
-     *
-     * @return array<string, mixed>
-     */
-    private function extractConstants(string $content): array
-    {
-        $constants = [];
-        
-        // Split content into lines and process each line
-        $lines = explode("\n", $content);
-        
-        foreach ($lines as $line) {
-            $line = trim($line);
-            
-            // Match #define statements with values (not header guards)
-            if (preg_match('/^#define\s+(\w+)\s+(.+)$/', $line, $matches)) {
-                $name = $matches[1];
-                $value = trim($matches[2]);
-                
-                // Skip header guards (defines without values or just identifiers)
-                if (empty($value) || $value === $name) {
-                    continue;
-                }
-                
-                // Try to convert value to appropriate type
-                $constants[$name] = $this->parseConstantValue($value);
-            }
-        }
-        
-        return $constants;
-    }
-
     /**
      * Parse constant value and convert to appropriate PHP type
      */
@@ -307,23 +549,4 @@ class HeaderAnalyzer implements AnalyzerInterface
         // Return as string for other cases
         return $value;
     }
-
-    /**
-     * Extract include dependencies from header content
-     *
-     * @return array<string>
-     */
-    private function extractDependencies(string $content): array
-    {
-        $dependencies = [];
-        
-        // Pattern to match #include statements
-        $pattern = '/#include\s+[<"]([^>"]+)[>"]/';
-        
-        if (preg_match_all($pattern, $content, $matches)) {
-            $dependencies = array_unique($matches[1]);
-        }
-        
-        return array_values($dependencies);
-    }
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Analyzer;
+
+use Yangweijie\CWrapper\Exception\AnalysisException;
+
+/**
+ * Streaming tokenizer for C header files
+ *
+ * Reads the file in fixed-size chunks and yields tokens in one forward
+ * pass. Comments are dropped, preprocessor directives are yielded as one
+ * token per logical line. Only the unconsumed tail of the current chunk, or
+ * the current line when it is longer, is buffered, so memory does not grow
+ * with the size of the header.
+ */
+class HeaderLexer
+{
+    public const IDENTIFIER = 1;
+    public const NUMBER = 2;
+    public const STRING = 3;
+    public const PUNCTUATOR = 4;
+    public const DIRECTIVE = 5;
+
+    /**
+     * Bytes read from the file at a time
+     */
+    private const CHUNK_SIZE = 65536;
+
+    /**
+     * Token patterns, anchored at the current position
+     */
+    private const TOKEN_PATTERN = '/\G(?:([A-Za-z_]\w*)|(\.?\d(?:[eEpP][+-]|[\w.])*)|("(?:[^"\\\\\n]|\\\\.)*"|\'(?:[^\'\\\\\n]|\\\\.)*\')|(\.\.\.|->|::|[^\s\w]))/';
+
+    private int $chunkSize;
+
+    public function __construct(int $chunkSize = self::CHUNK_SIZE)
+    {
+        $this->chunkSize = max(16, $chunkSize);
+    }
+
+    /**
+     * Tokenize a header file
+     *
+     * Each token is [kind, text, spaceBefore]; spaceBefore tells whether
+     * whitespace or a comment separated it from the previous token, so the
+     * source can be rebuilt with collapsed whitespace.
+     *
+     * @param string $path Path to the header file
+     * @return \Generator<int, array{int, string, bool}> Tokens
+     * @throws AnalysisException If the file cannot be read
+     */
+    public function tokenize(string $path): \Generator
+    {
+        $handle = @fopen($path, 'rb');
+        if ($handle === false) {
+            throw new AnalysisException("Failed to read header file: {$path}");
+        }
+
+        try {
+            yield from $this->scan($handle);
+        } finally {
+            fclose($handle);
+        }
+    }
+
+    /**
+     * Tokenize header content that is already in memory
+     *
+     * @param string $content Header source
+     * @return \Generator<int, array{int, string, bool}> Tokens, as for tokenize()
+     */
+    public function tokenizeString(string $content): \Generator
+    {
+        yield from $this->scan(null, $content, true);
+    }
+
+    /**
+     * Scan an open stream, or only the initial buffer when it holds the whole input
+     *
+     * @param resource|null $handle Stream to read, null when $eof is set
+     * @param string $buffer Input already read
+     * @param bool $eof Whether the buffer holds the rest of the input
+     * @return \Generator<int, array{int, string, bool}> Tokens
+     */
+    private function scan($handle, string $buffer = '', bool $eof = false): \Generator
+    {
+        $pos = 0;
+        $space = false;
+        $lineStart = true;
+
+        while (true) {
+            // Refill when the rest of the buffer may hold an incomplete token
+            if (!$eof && strlen($buffer) - $pos < $this->chunkSize) {
+                $buffer = substr($buffer, $pos) . $this->read($handle, $eof);
+                $pos = 0;
+            }
+
+            $length = strlen($buffer);
+            if ($pos >= $length) {
+                return;
+            }
+
+            $char = $buffer[$pos];
+
+            if ($char === ' ' || $char === "\t" || $char === "\n" || $char === "\r" || $char === "\f" || $char === "\v") {
+                $end = $pos + strspn($buffer, " \t\n\r\f\v", $pos);
+                $lineStart = $lineStart || strcspn($buffer, "\n", $pos, $end - $pos) < $end - $pos;
+                $space = true;
+                $pos = $end;
+                continue;
+            }
+
+            if ($char === '/' && $pos + 1 < $length && ($buffer[$pos + 1] === '/' || $buffer[$pos + 1] === '*')) {
+                $block = $buffer[$pos + 1] === '*';
+                [$buffer, $pos, $found] = $this->skipUntil($handle, $buffer, $pos + 2, $block ? '*/' : "\n", $eof);
+                if ($found && !$block) {
+                    // The newline ends the comment and starts a new line
+                    $lineStart = true;
+                    $pos++;
+                }
+                $space = true;
+                continue;
+            }
+
+            if ($char === '#' && $lineStart) {
+                [$directive, $buffer, $pos] = $this->readDirective($handle, $buffer, $pos + 1, $eof);
+                yield [self::DIRECTIVE, $directive, true];
+                $space = true;
+                $lineStart = true;
+                continue;
+            }
+
+            // Tokens never span lines, so a token longer than a chunk waits for the end of its line
+            if (!$eof && strpos($buffer, "\n", $pos) === false) {
+                $buffer = substr($buffer, $pos) . $this->read($handle, $eof);
+                $pos = 0;
+                continue;
+            }
+
+            // Every non-space character starts a token, a lone quote is punctuation
+            preg_match(self::TOKEN_PATTERN, $buffer, $match, 0, $pos);
+
+            $kind = match (true) {
+                ($match[1] ?? '') !== '' => self::IDENTIFIER,
+                ($match[2] ?? '') !== '' => self::NUMBER,
+                ($match[3] ?? '') !== '' => self::STRING,
+                default => self::PUNCTUATOR,
+            };
+
+            $text = $match[0];
+            yield [$kind, $text, $space];
+
+            $pos += strlen($text);
+            $space = false;
+            $lineStart = false;
+        }
+    }
+
+    /**
+     * Skip to the end of a terminator, reading further chunks as needed
+     *
+     * @param resource $handle Stream to read
+     * @return array{string, int, bool} Buffer, position after the terminator (before it for newlines), whether it was found
+     */
+    private function skipUntil($handle, string $buffer, int $pos, string $terminator, bool &$eof): array
+    {
+        while (true) {
+            $found = strpos($buffer, $terminator, $pos);
+
+            if ($found !== false) {
+                return [$buffer, $terminator === "\n" ? $found : $found + strlen($terminator), true];
+            }
+
+            if ($eof) {
+                return [$buffer, strlen($buffer), false];
+            }
+
+            // Keep only what could be the start of the terminator
+            $keep = max($pos, strlen($buffer) - strlen($terminator) + 1);
+            $buffer = substr($buffer, $keep) . $this->read($handle, $eof);
+            $pos = 0;
+        }
+    }
+
+    /**
+     * Read a preprocessor directive up to the end of its logical line
+     *
+     * @param resource $handle Stream to read
+     * @return array{string, string, int} Directive text without comments, buffer, position after the line
+     */
+    private function readDirective($handle, string $buffer, int $pos, bool &$eof): array
+    {
+        $text = '';
+
+        while (true) {
+            $newline = strpos($buffer, "\n", $pos);
+
+            if ($newline === false && !$eof) {
+                $text .= substr($buffer, $pos);
+                $buffer = $this->read($handle, $eof);
+                $pos = 0;
+                continue;
+            }
+
+            $end = $newline === false ? strlen($buffer) : $newline;
+            $text .= substr($buffer, $pos, $end - $pos);
+            $pos = $newline === false ? $end : $end + 1;
+
+            // A backslash before the newline continues the directive
+            $trimmed = rtrim($text, "\r");
+            if ($newline !== false && str_ends_with($trimmed, '\\')) {
+                $text = substr($trimmed, 0, -1) . ' ';
+                continue;
+            }
+
+            // A block comment left open on this line spans further lines
+            $text = preg_replace('/\/\*.*?\*\//s', ' ', $text) ?? $text;
+            $lineComment = strpos($text, '//');
+            $open = strpos($lineComment === false ? $text : substr($text, 0, $lineComment), '/*');
+            if ($open !== false && $newline !== false) {
+                [$buffer, $pos] = $this->skipUntil($handle, $buffer, $pos, '*/', $eof);
+                $text = substr($text, 0, $open) . ' ';
+                continue;
+            }
+
+            break;
+        }
+
+        $text = preg_replace('/\/\/.*$/s', ' ', $text) ?? $text;
+
+        return [trim(preg_replace('/\s+/', ' ', $text) ?? $text), $buffer, $pos];
+    }
+
+    /**
+     * Read the next chunk
+     *
+     * @param resource $handle Stream to read
+     */
+    private function read($handle, bool &$eof): string
+    {
+        $chunk = fread($handle, $this->chunkSize);
+
+        if ($chunk === false || $chunk === '' || feof($handle)) {
+            $eof = true;
+        }
+
+        return $chunk === false ? '' : $chunk;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Analyzer;
+
+use Symfony\Component\Process\Process;
+use Yangweijie\CWrapper\Exception\AnalysisException;
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Generator\OutputWriter;
+
+/**
+ * Expands headers with the system C preprocessor and caches the result
+ *
+ * Runs `cpp -E -dD` with the configured defines and include paths, so
+ * conditional declarations and include guards are resolved the way the
+ * compiler resolves them; -dD keeps the #define directives for constants.
+ * Expanded output is stored content-addressed, keyed by the hashes of every
+ * file the preprocessor read plus the options. An index entry per header
+ * remembers that closure with the mtime and size of every file, so an
+ * unchanged header is neither preprocessed, walked for includes nor hashed
+ * again; only files whose mtime or size changed are rehashed.
+ */
+class HeaderPreprocessor
+{
+    /**
+     * Cache layout version, bump when the cached data changes meaning
+     */
+    private const FORMAT = 3;
+
+    /**
+     * Timeout of one preprocessor run in seconds
+     */
+    private const TIMEOUT = 120;
+
+    private string $cacheDir;
+    private string $cpp;
+    private OutputWriter $writer;
+    private SourceFileRepository $sources;
+
+    /** @var array<string, array{output: string, closure: array<string>}> */
+    private array $results = [];
+
+    /**
+     * @param array<string> $defines Macros as NAME or NAME=VALUE
+     * @param array<string> $includePaths Additional include directories
+     * @param string|null $cacheDir Cache directory, the preprocessed directory of the per-user cache by default
+     * @param string|null $cpp Preprocessor command, $CPP or cpp by default
+     * @param OutputWriter|null $writer Writer of the cache files
+     * @param SourceFileRepository|null $sources Repository the files of a closure are hashed from
+     * @throws GenerationException If the default cache directory cannot be created
+     */
+    public function __construct(
+        private readonly array $defines = [],
+        private readonly array $includePaths = [],
+        ?string $cacheDir = null,
+        ?string $cpp = null,
+        ?OutputWriter $writer = null,
+        ?SourceFileRepository $sources = null
+    ) {
+        $this->cacheDir = $cacheDir ?? CacheDirectory::get(null, 'preprocessed');
+        $this->cpp = $cpp ?? (getenv('CPP') ?: 'cpp');
+        $this->writer = $writer ?? new OutputWriter();
+        $this->sources = $sources ?? new SourceFileRepository();
+    }
+
+    /**
+     * Expand a header, reusing the cached output when nothing it read changed
+     *
+     * The result is kept for the lifetime of the instance, so the stages of
+     * one run sharing it check the cache once per header.
+     *
+     * @param string $headerPath Header file
+     * @return array{output: string, closure: array<string>} Expanded file and every file the preprocessor read
+     * @throws AnalysisException If the header cannot be preprocessed
+     */
+    public function preprocess(string $headerPath): array
+    {
+        $realPath = realpath($headerPath);
+        if ($realPath === false) {
+            throw new AnalysisException("Header file not found: {$headerPath}");
+        }
+
+        return $this->results[$realPath] ??= $this->expand($realPath, $headerPath);
+    }
+
+    /**
+     * Expand a header through the cache
+     *
+     * @param string $realPath Resolved header path
+     * @param string $headerPath Header file as given, for error messages
+     * @return array{output: string, closure: array<string>} Expanded file and every file the preprocessor read
+     * @throws AnalysisException If the header cannot be preprocessed
+     */
+    private function expand(string $realPath, string $headerPath): array
+    {
+        $indexFile = $this->cacheDir . '/index/' . hash('sha256', json_encode([$realPath, $this->getOptions()], JSON_THROW_ON_ERROR)) . '.json';
+        $index = is_file($indexFile) ? json_decode((string) file_get_contents($indexFile), true) : null;
+
+        if (is_array($index) && ($index['format'] ?? null) === self::FORMAT && is_array($index['closure'] ?? null)) {
+            $closure = $this->hashFiles(array_keys($index['closure']), $index['closure']);
+            $key = (string) ($index['key'] ?? '');
+            $output = $this->cacheDir . '/' . $key . '.i';
+
+            if (array_column($closure, 'hash') === array_column($index['closure'], 'hash') && is_file($output)) {
+                // Files touched without a content change get their new stat recorded
+                if ($closure !== $index['closure']) {
+                    $this->writeIndex($indexFile, $key, $closure, $headerPath);
+                }
+
+                return ['output' => $output, 'closure' => array_keys($closure)];
+            }
+        }
+
+        $expanded = $this->run($realPath);
+        $closure = $this->hashFiles($this->extractClosure($expanded, $realPath));
+        $key = $this->createKey($closure);
+        $output = $this->cacheDir . '/' . $key . '.i';
+
+        try {
+            $this->writer->write($output, $expanded);
+        } catch (\Exception $e) {
+            throw new AnalysisException("Failed to cache preprocessed header {$headerPath}: " . $e->getMessage(), 0, $e);
+        }
+
+        $this->writeIndex($indexFile, $key, $closure, $headerPath);
+
+        return ['output' => $output, 'closure' => array_keys($closure)];
+    }
+
+    /**
+     * Get the files read while preprocessing a set of headers
+     *
+     * Replaces the #include walk of DependencyResolver: only includes the
+     * preprocessor actually followed, under the configured defines, appear.
+     *
+     * @param array<string> $headerPaths Header files
+     * @return array<string> Files in order of first inclusion
+     * @throws AnalysisException If a header cannot be preprocessed
+     */
+    public function getIncludeClosure(array $headerPaths): array
+    {
+        $closure = [];
+
+        foreach ($headerPaths as $headerPath) {
+            foreach ($this->preprocess($headerPath)['closure'] as $file) {
+                $closure[$file] = true;
+            }
+        }
+
+        return array_keys($closure);
+    }
+
+    /**
+     * Run the preprocessor
+     *
+     * @param string $headerPath Resolved header path
+     * @return string Expanded source
+     * @throws AnalysisException If the preprocessor fails
+     */
+    private function run(string $headerPath): string
+    {
+        $command = [$this->cpp, '-E', '-dD'];
+
+        foreach ($this->defines as $define) {
+            $command[] = '-D' . $define;
+        }
+
+        foreach ($this->includePaths as $includePath) {
+            $command[] = '-I' . $includePath;
+        }
+
+        $command[] = $headerPath;
+
+        $process = new Process($command);
+        $process->setTimeout(self::TIMEOUT);
+
+        try {
+            $process->run();
+        } catch (\Exception $e) {
+            throw new AnalysisException("Failed to run the C preprocessor ({$this->cpp}): " . $e->getMessage(), 0, $e);
+        }
+
+        if (!$process->isSuccessful()) {
+            throw new AnalysisException(
+                "The C preprocessor failed on {$headerPath}: " . trim($process->getErrorOutput() ?: $process->getOutput())
+            );
+        }
+
+        return $process->getOutput();
+    }
+
+    /**
+     * Collect the files named by the line markers of preprocessed output
+     *
+     * @param string $expanded Expanded source
+     * @param string $headerPath Resolved path of the preprocessed header
+     * @return array<string> Resolved file paths, the header first
+     */
+    private function extractClosure(string $expanded, string $headerPath): array
+    {
+        $files = [$headerPath => true];
+
+        preg_match_all('/^#\s*\d+\s+"((?:[^"\\\\]|\\\\.)+)"/m', $expanded, $matches);
+
+        foreach (array_unique($matches[1]) as $file) {
+            $file = stripcslashes($file);
+            $realPath = realpath($file);
+
+            // <built-in> and <command-line> are not files
+            if ($realPath !== false && is_file($realPath)) {
+                $files[$realPath] = true;
+            }
+        }
+
+        return array_keys($files);
+    }
+
+    /**
+     * Record the closure and expansion of a header
+     *
+     * @param string $indexFile Index entry of the header
+     * @param string $key Cache key of the expansion
+     * @param array<string, array{hash: string, mtime: int, size: int}> $closure Files read
+     * @param string $headerPath Header file, for error messages
+     * @throws AnalysisException If the index cannot be written
+     */
+    private function writeIndex(string $indexFile, string $key, array $closure, string $headerPath): void
+    {
+        try {
+            $this->writer->write($indexFile, json_encode([
+                'format' => self::FORMAT,
+                'key' => $key,
+                'closure' => $closure,
+            ], JSON_PRETTY_PRINT | JSON_UNESCAPED_SLASHES | JSON_THROW_ON_ERROR) . "\n");
+        } catch (\Exception $e) {
+            throw new AnalysisException("Failed to cache preprocessed header {$headerPath}: " . $e->getMessage(), 0, $e);
+        }
+    }
+
+    /**
+     * Hash a list of files, reusing known hashes of files whose mtime and size did not change
+     *
+     * Changed files are read through the source repository, so a header the
+     * other stages of the run need is read from disk only once.
+     *
+     * @param array<string> $files File paths
+     * @param array<string, mixed> $known Entries of a previous run keyed by path
+     * @return array<string, array{hash: string, mtime: int, size: int}> Content hash and stat keyed by path, empty hash for missing files
+     * @throws AnalysisException If a file cannot be read
+     */
+    private function hashFiles(array $files, array $known = []): array
+    {
+        $entries = [];
+
+        foreach ($files as $file) {
+            $stat = is_file($file) ? @stat($file) : false;
+
+            if ($stat === false) {
+                $entries[$file] = ['hash' => '', 'mtime' => 0, 'size' => 0];
+                continue;
+            }
+
+            $entry = $known[$file] ?? null;
+            $unchanged = is_array($entry) && is_string($entry['hash'] ?? null) && $entry['hash'] !== ''
+                && ($entry['mtime'] ?? null) === $stat['mtime'] && ($entry['size'] ?? null) === $stat['size'];
+
+            $entries[$file] = [
+                'hash' => $unchanged ? $entry['hash'] : $this->sources->get($file)->getHash(),
+                'mtime' => $stat['mtime'],
+                'size' => $stat['size'],
+            ];
+        }
+
+        return $entries;
+    }
+
+    /**
+     * Compute the content address of an expansion
+     *
+     * @param array<string, array{hash: string, mtime: int, size: int}> $closure Files read
+     * @return string Cache key
+     */
+    private function createKey(array $closure): string
+    {
+        return hash('sha256', json_encode([array_column($closure, 'hash'), array_keys($closure), $this->getOptions()], JSON_THROW_ON_ERROR));
+    }
+
+    /**
+     * Get the options that change the expansion
+     *
+     * @return array{cpp: string, defines: array<string>, includePaths: array<string>}
+     */
+    private function getOptions(): array
+    {
+        return [
+            'cpp' => $this->cpp,
+            'defines' => $this->defines,
+            'includePaths' => array_map(fn($path) => realpath($path) ?: $path, $this->includePaths),
+        ];
+    }
+}
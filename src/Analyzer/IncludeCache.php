@@ -0,0 +1,231 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Analyzer;
+
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Generator\OutputWriter;
+
+/**
+ * Persistent cache of include lists and include path resolutions
+ *
+ * The #include lines of a header are kept until its mtime or size changes.
+ * The result of resolving an include is kept together with the mtime of
+ * every directory probed for it: adding or removing a file changes the
+ * directory mtime, so a resolution is only reused while no candidate
+ * location can have appeared or disappeared. Directory mtimes are stat'ed
+ * once per process. The cache file lives in the private cache root, one per
+ * project when the caller names it, so other users cannot plant resolutions.
+ */
+class IncludeCache
+{
+    /**
+     * Cache layout version, bump when the cached data changes meaning
+     */
+    private const FORMAT = 1;
+
+    /**
+     * Cached data of files and resolutions
+     *
+     * @var array{files: array<string, array{mtime: int, size: int, includes: array<string>}>, resolutions: array<string, array{path: string|null, dirs: array<string, int>}>}
+     */
+    private array $data = ['files' => [], 'resolutions' => []];
+
+    /**
+     * Directory mtimes of this process, -1 for missing directories
+     *
+     * @var array<string, int>
+     */
+    private array $directoryMtimes = [];
+
+    private bool $loaded = false;
+    private bool $dirty = false;
+    private OutputWriter $writer;
+
+    /**
+     * @param string|null $file Cache file, include-cache.json in the per-user cache root by default; an empty string keeps the cache in memory
+     */
+    public function __construct(private ?string $file = null, ?OutputWriter $writer = null)
+    {
+        $this->writer = $writer ?? new OutputWriter();
+    }
+
+    /**
+     * Get the cache file of a project
+     *
+     * @param string $projectPath Directory identifying the project, e.g. its output path
+     * @param string|null $cacheRoot Cache root, the per-user default when null
+     * @return string Cache file path
+     * @throws GenerationException If the cache directory cannot be created
+     */
+    public static function getProjectFile(string $projectPath, ?string $cacheRoot = null): string
+    {
+        $project = hash('xxh128', realpath($projectPath) ?: $projectPath);
+
+        return CacheDirectory::get($cacheRoot, 'include') . '/' . $project . '.json';
+    }
+
+    /**
+     * Get the cached #include names of a header
+     *
+     * @param string $realPath Resolved header path
+     * @return array<string>|null Include names, null if unknown or the header changed
+     */
+    public function getIncludes(string $realPath): ?array
+    {
+        $this->load();
+        $entry = $this->data['files'][$realPath] ?? null;
+
+        if ($entry === null) {
+            return null;
+        }
+
+        $stat = @stat($realPath);
+        if ($stat === false || $stat['mtime'] !== $entry['mtime'] || $stat['size'] !== $entry['size']) {
+            return null;
+        }
+
+        return $entry['includes'];
+    }
+
+    /**
+     * Remember the #include names of a header
+     *
+     * @param string $realPath Resolved header path
+     * @param array<string> $includes Include names
+     */
+    public function setIncludes(string $realPath, array $includes): void
+    {
+        $stat = @stat($realPath);
+        if ($stat === false) {
+            return;
+        }
+
+        $this->load();
+        $this->data['files'][$realPath] = ['mtime' => $stat['mtime'], 'size' => $stat['size'], 'includes' => $includes];
+        $this->dirty = true;
+    }
+
+    /**
+     * Get a cached include resolution
+     *
+     * @param string $key Include name, including directory and search paths
+     * @return array{path: string|null}|null Resolved path (null if not found), null if unknown or a probed directory changed
+     */
+    public function getResolution(string $key): ?array
+    {
+        $this->load();
+        $entry = $this->data['resolutions'][$key] ?? null;
+
+        if ($entry === null) {
+            return null;
+        }
+
+        foreach ($entry['dirs'] as $directory => $mtime) {
+            if ($this->getDirectoryMtime($directory) !== $mtime) {
+                return null;
+            }
+        }
+
+        return ['path' => $entry['path']];
+    }
+
+    /**
+     * Remember an include resolution
+     *
+     * @param string $key Include name, including directory and search paths
+     * @param string|null $path Resolved path, null if not found
+     * @param array<string> $probedDirectories Directories looked into until the include was found
+     */
+    public function setResolution(string $key, ?string $path, array $probedDirectories): void
+    {
+        $dirs = [];
+        foreach ($probedDirectories as $directory) {
+            $dirs[$directory] = $this->getDirectoryMtime($directory);
+        }
+
+        $this->load();
+        $this->data['resolutions'][$key] = ['path' => $path, 'dirs' => $dirs];
+        $this->dirty = true;
+    }
+
+    /**
+     * Write the cache if it changed
+     */
+    public function save(): void
+    {
+        if (!$this->dirty || $this->getFile() === '') {
+            return;
+        }
+
+        try {
+            $this->writer->write(
+                $this->file,
+                json_encode(['format' => self::FORMAT] + $this->data, JSON_UNESCAPED_SLASHES | JSON_THROW_ON_ERROR)
+            );
+            $this->dirty = false;
+        } catch (\Exception) {
+            // The cache only saves file system probes, resolution works without it
+        }
+    }
+
+    /**
+     * Get the mtime of a directory once per process
+     *
+     * @param string $directory Directory path
+     * @return int Modification time, -1 if the directory does not exist
+     */
+    private function getDirectoryMtime(string $directory): int
+    {
+        if (!isset($this->directoryMtimes[$directory])) {
+            $mtime = is_dir($directory) ? @filemtime($directory) : false;
+            $this->directoryMtimes[$directory] = $mtime === false ? -1 : $mtime;
+        }
+
+        return $this->directoryMtimes[$directory];
+    }
+
+    /**
+     * Load the cache file on first use
+     */
+    private function load(): void
+    {
+        if ($this->loaded) {
+            return;
+        }
+
+        $this->loaded = true;
+
+        if ($this->getFile() === '' || !is_file($this->file)) {
+            return;
+        }
+
+        $data = json_decode((string) file_get_contents($this->file), true);
+
+        if (is_array($data) && ($data['format'] ?? null) === self::FORMAT
+            && is_array($data['files'] ?? null) && is_array($data['resolutions'] ?? null)) {
+            $this->data = ['files' => $data['files'], 'resolutions' => $data['resolutions']];
+        }
+    }
+
+    /**
+     * Get the cache file, resolving the default on first use
+     *
+     * @return string Cache file path, empty when the cache is kept in memory
+     */
+    private function getFile(): string
+    {
+        if ($this->file === null) {
+            try {
+                $this->file = CacheDirectory::get(null) . '/include-cache.json';
+            } catch (GenerationException) {
+                // Resolution works without a persistent cache
+                $this->file = '';
+            }
+        }
+
+        return $this->file;
+    }
+}
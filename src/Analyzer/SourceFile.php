@@ -0,0 +1,131 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Analyzer;
+
+/**
+ * Content of a header file read once, with the data derived from it
+ *
+ * The line index, content hash and include list are computed on first use
+ * and kept for every later stage of the run.
+ */
+class SourceFile
+{
+    /** @var array<int>|null */
+    private ?array $lineIndex = null;
+
+    private ?string $hash = null;
+
+    /** @var array<string>|null */
+    private ?array $includes = null;
+
+    /**
+     * @param string $path Resolved file path
+     * @param string $content File content
+     */
+    public function __construct(
+        public readonly string $path,
+        public readonly string $content
+    ) {
+    }
+
+    /**
+     * Get the offsets at which lines start
+     *
+     * @return array<int> Byte offset of each line, the first line at index 0
+     */
+    public function getLineIndex(): array
+    {
+        if ($this->lineIndex === null) {
+            $this->lineIndex = [0];
+            $offset = 0;
+
+            while (($offset = strpos($this->content, "\n", $offset)) !== false) {
+                $this->lineIndex[] = ++$offset;
+            }
+        }
+
+        return $this->lineIndex;
+    }
+
+    /**
+     * Get the line a byte offset lies on
+     *
+     * @param int $offset Byte offset in the content
+     * @return int Line number, starting at 1
+     */
+    public function getLineNumber(int $offset): int
+    {
+        $lineIndex = $this->getLineIndex();
+        $low = 0;
+        $high = count($lineIndex) - 1;
+
+        while ($low < $high) {
+            $middle = intdiv($low + $high + 1, 2);
+
+            if ($lineIndex[$middle] <= $offset) {
+                $low = $middle;
+            } else {
+                $high = $middle - 1;
+            }
+        }
+
+        return $low + 1;
+    }
+
+    /**
+     * Get the SHA-256 hash of the content
+     */
+    public function getHash(): string
+    {
+        return $this->hash ??= hash('sha256', $this->content);
+    }
+
+    /**
+     * Get the names of the files included by #include statements
+     *
+     * Directives are read through HeaderLexer, so includes in comments and
+     * in #if 0 blocks are not followed.
+     *
+     * @return array<string> Include names as written, e.g. "stdio.h"
+     */
+    public function getIncludes(): array
+    {
+        if ($this->includes !== null) {
+            return $this->includes;
+        }
+
+        $this->includes = [];
+
+        if (!str_contains($this->content, 'include')) {
+            return $this->includes;
+        }
+
+        // Nesting depth inside an #if 0 block, 0 outside
+        $disabled = 0;
+
+        foreach ((new HeaderLexer())->tokenizeString($this->content) as [$kind, $text]) {
+            if ($kind !== HeaderLexer::DIRECTIVE) {
+                continue;
+            }
+
+            if ($disabled > 0) {
+                if (preg_match('/^if(?:n?def)?\b/', $text)) {
+                    $disabled++;
+                } elseif (preg_match('/^endif\b/', $text)) {
+                    $disabled--;
+                } elseif ($disabled === 1 && preg_match('/^el(?:se|if)\b/', $text)) {
+                    // The other branch may be compiled
+                    $disabled = 0;
+                }
+            } elseif (preg_match('/^if\s+0$/', $text)) {
+                $disabled = 1;
+            } elseif (preg_match('/^include\s*[<"]([^>"]+)[>"]/', $text, $matches)) {
+                $this->includes[] = $matches[1];
+            }
+        }
+
+        return $this->includes;
+    }
+}
\ No newline at end of file
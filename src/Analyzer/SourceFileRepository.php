@@ -0,0 +1,50 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Analyzer;
+
+use Yangweijie\CWrapper\Exception\AnalysisException;
+
+/**
+ * Loads each header file once per run and shares it between stages
+ *
+ * Dependency resolution, analysis, declaration building, preprocessor cache
+ * validation and the output manifest all ask the repository for a header,
+ * so this process reads the file from disk a single time however many of
+ * these stages need its content. Other readers remain: klitsche/ffigen
+ * parses the headers itself, `cpp` reads them when preprocessing, and the
+ * analyzer then tokenizes the expanded output instead of the headers.
+ * Render workers receive the generation plan and read no header.
+ */
+class SourceFileRepository
+{
+    /** @var array<string, SourceFile> */
+    private array $files = [];
+
+    /**
+     * Get a header file, reading it on first request
+     *
+     * @param string $path Path to the header file
+     * @return SourceFile Loaded file
+     * @throws AnalysisException If the file does not exist or cannot be read
+     */
+    public function get(string $path): SourceFile
+    {
+        $realPath = realpath($path);
+        if ($realPath === false) {
+            throw new AnalysisException("Header file not found: {$path}");
+        }
+
+        if (isset($this->files[$realPath])) {
+            return $this->files[$realPath];
+        }
+
+        $content = @file_get_contents($realPath);
+        if ($content === false) {
+            throw new AnalysisException("Failed to read header file: {$path}");
+        }
+
+        return $this->files[$realPath] = new SourceFile($realPath, $content);
+    }
+}
\ No newline at end of file
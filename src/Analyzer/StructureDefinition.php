@@ -13,11 +13,15 @@ class StructureDefinition
      * @param string $name Structure name
      * @param array<array{name: string, type: string}> $fields Structure fields
      * @param bool $isUnion Whether this is a union type
+     * @param string|null $tag Struct or union tag, null for anonymous structures
+     * @param string|null $cType C type to allocate, null for "struct <name>"
      */
     public function __construct(
         public readonly string $name,
         public readonly array $fields,
-        public readonly bool $isUnion = false
+        public readonly bool $isUnion = false,
+        public readonly ?string $tag = null,
+        public readonly ?string $cType = null
     ) {
     }
 }
\ No newline at end of file
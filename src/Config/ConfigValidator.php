@@ -22,6 +22,7 @@ class ConfigValidator
         $this->validatePaths($config);
         $this->validateNamespace($config);
         $this->validateExcludePatterns($config);
+        $this->validateGenerationSettings($config);
     }
 
     /**
@@ -218,6 +219,46 @@ class ConfigValidator
         }
     }
 
+    /**
+     * Validate that generation settings can be combined
+     *
+     * @throws ConfigurationException
+     */
+    public function validateGenerationSettings(ProjectConfig $config): void
+    {
+        $generation = $config->getGenerationConfig();
+
+        if ($generation->isPreloadEnabled() && $generation->isSplitScopesEnabled()) {
+            throw new ConfigurationException('Split scopes cannot be combined with preload, a preloaded scope is already shared by all workers');
+        }
+
+        if ($generation->isSplitScopesEnabled() && $generation->getStructBackend() === 'cdata') {
+            throw new ConfigurationException('Split scopes cannot be combined with the cdata struct backend, structs allocated through Bootstrap::getFFI() are not compatible with the types of a per-class scope');
+        }
+
+        if ($generation->isPreloadEnabled() && !empty($generation->getBatchFunctions())) {
+            throw new ConfigurationException('Batch functions cannot be combined with preload, the batch shim is loaded with FFI::cdef() which ffi.enable=preload forbids');
+        }
+
+        if (!empty($generation->getBatchFunctions()) && $config->getLibraryFile() === '') {
+            throw new ConfigurationException('Batch functions require a library file for the shim to link against');
+        }
+
+        if ($generation->isSharedStatsEnabled() && !$generation->isInstrumentEnabled()) {
+            throw new ConfigurationException('Shared statistics are collected by the instrumented wrappers, enable instrument as well');
+        }
+
+        if (!empty($generation->getDefines()) && !$generation->isPreprocessEnabled()) {
+            throw new ConfigurationException('Defines are applied by the C preprocessor, enable preprocess as well');
+        }
+
+        foreach ($generation->getIncludePaths() as $includePath) {
+            if (!is_dir($includePath)) {
+                throw new ConfigurationException("Include path is not a directory: {$includePath}");
+            }
+        }
+    }
+
     /**
      * Validate configuration schema from array data
      *
@@ -238,7 +279,7 @@ class ConfigValidator
     {
         $allowedKeys = [
             'headerFiles', 'libraryFile', 'outputPath', 'namespace', 
-            'excludePatterns', 'validation'
+            'excludePatterns', 'validation', 'generationType', 'generation'
         ];
 
         foreach (array_keys($data) as $key) {
@@ -282,6 +323,19 @@ class ConfigValidator
         if (isset($data['validation']) && is_array($data['validation'])) {
             $this->validateValidationSchema($data['validation']);
         }
+
+        if (isset($data['generationType']) && !is_string($data['generationType'])) {
+            throw new ConfigurationException('generationType must be a string');
+        }
+
+        if (isset($data['generation']) && !is_array($data['generation'])) {
+            throw new ConfigurationException('generation must be an array');
+        }
+
+        // Validate generation sub-schema
+        if (isset($data['generation']) && is_array($data['generation'])) {
+            $this->validateGenerationSchema($data['generation']);
+        }
     }
 
     /**
@@ -310,4 +364,107 @@ class ConfigValidator
             throw new ConfigurationException('customValidationRules must be an array');
         }
     }
+
+    /**
+     * @param array<string, mixed> $generationData
+     * @throws ConfigurationException
+     */
+    private function validateGenerationSchema(array $generationData): void
+    {
+        $allowedKeys = ['preload', 'declarationStorage', 'splitScopes', 'directDispatch', 'profile', 'batchFunctions', 'structBackend', 'outParams', 'instrument', 'sharedStats', 'jobs', 'preprocess', 'defines', 'includePaths', 'cacheDir'];
+
+        foreach (array_keys($generationData) as $key) {
+            if (!in_array($key, $allowedKeys, true)) {
+                throw new ConfigurationException("Unknown generation configuration key: {$key}");
+            }
+        }
+
+        if (isset($generationData['preload']) && !is_bool($generationData['preload'])) {
+            throw new ConfigurationException('preload must be a boolean');
+        }
+
+        if (isset($generationData['splitScopes']) && !is_bool($generationData['splitScopes'])) {
+            throw new ConfigurationException('splitScopes must be a boolean');
+        }
+
+        if (isset($generationData['directDispatch']) && !is_bool($generationData['directDispatch'])) {
+            throw new ConfigurationException('directDispatch must be a boolean');
+        }
+
+        if (isset($generationData['outParams']) && !is_bool($generationData['outParams'])) {
+            throw new ConfigurationException('outParams must be a boolean');
+        }
+
+        if (isset($generationData['instrument']) && !is_bool($generationData['instrument'])) {
+            throw new ConfigurationException('instrument must be a boolean');
+        }
+
+        if (isset($generationData['sharedStats']) && !is_bool($generationData['sharedStats'])) {
+            throw new ConfigurationException('sharedStats must be a boolean');
+        }
+
+        if (isset($generationData['jobs']) && (!is_int($generationData['jobs']) || $generationData['jobs'] < 1)) {
+            throw new ConfigurationException('jobs must be a positive integer');
+        }
+
+        if (isset($generationData['preprocess']) && !is_bool($generationData['preprocess'])) {
+            throw new ConfigurationException('preprocess must be a boolean');
+        }
+
+        if (isset($generationData['cacheDir']) && (!is_string($generationData['cacheDir']) || $generationData['cacheDir'] === '')) {
+            throw new ConfigurationException('cacheDir must be a non-empty string');
+        }
+
+
+        if (isset($generationData['declarationStorage'])
+            && !in_array($generationData['declarationStorage'], GenerationConfig::DECLARATION_STORAGES, true)) {
+            throw new ConfigurationException("declarationStorage must be 'constant' or 'file'");
+        }
+
+        if (isset($generationData['profile'])
+            && !in_array($generationData['profile'], GenerationConfig::PROFILES, true)) {
+            throw new ConfigurationException("profile must be 'debug' or 'release'");
+        }
+
+        if (isset($generationData['structBackend'])
+            && !in_array($generationData['structBackend'], GenerationConfig::STRUCT_BACKENDS, true)) {
+            throw new ConfigurationException("structBackend must be 'properties' or 'cdata'");
+        }
+
+        if (isset($generationData['batchFunctions'])) {
+            if (!is_array($generationData['batchFunctions'])) {
+                throw new ConfigurationException('batchFunctions must be an array');
+            }
+
+            foreach ($generationData['batchFunctions'] as $index => $function) {
+                if (!is_string($function) || !preg_match('/^[A-Za-z_]\w*$/', $function)) {
+                    throw new ConfigurationException("batchFunctions[{$index}] must be a C function name");
+                }
+            }
+        }
+
+        if (isset($generationData['defines'])) {
+            if (!is_array($generationData['defines'])) {
+                throw new ConfigurationException('defines must be an array');
+            }
+
+            foreach ($generationData['defines'] as $index => $define) {
+                if (!is_string($define) || !preg_match('/^[A-Za-z_]\w*(?:=.*)?$/s', $define)) {
+                    throw new ConfigurationException("defines[{$index}] must be NAME or NAME=VALUE");
+                }
+            }
+        }
+
+        if (isset($generationData['includePaths'])) {
+            if (!is_array($generationData['includePaths'])) {
+                throw new ConfigurationException('includePaths must be an array');
+            }
+
+            foreach ($generationData['includePaths'] as $index => $includePath) {
+                if (!is_string($includePath) || $includePath === '') {
+                    throw new ConfigurationException("includePaths[{$index}] must be a directory path");
+                }
+            }
+        }
+    }
 }
\ No newline at end of file
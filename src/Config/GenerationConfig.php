@@ -0,0 +1,295 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Config;
+
+use Yangweijie\CWrapper\Exception\ConfigurationException;
+
+/**
+ * Configuration for code generation settings
+ */
+class GenerationConfig
+{
+    /**
+     * Supported storage locations for the embedded C declarations
+     */
+    public const DECLARATION_STORAGES = ['constant', 'file'];
+
+    /**
+     * Supported struct class backends: PHP property copies or in-place FFI\CData wrappers
+     */
+    public const STRUCT_BACKENDS = ['properties', 'cdata'];
+
+    /**
+     * Wrapper profiles: debug validates arguments against their C types, release emits the FFI call only
+     */
+    public const PROFILE_DEBUG = 'debug';
+    public const PROFILE_RELEASE = 'release';
+    public const PROFILES = [self::PROFILE_DEBUG, self::PROFILE_RELEASE];
+
+    public function __construct(
+        private bool $preload = false,
+        private string $declarationStorage = 'constant',
+        private bool $splitScopes = false,
+        private bool $directDispatch = false,
+        private string $profile = self::PROFILE_DEBUG,
+        private array $batchFunctions = [],
+        private string $structBackend = 'properties',
+        private bool $outParams = false,
+        private bool $instrument = false,
+        private bool $sharedStats = false,
+        private int $jobs = 1,
+        private bool $preprocess = false,
+        private array $defines = [],
+        private array $includePaths = [],
+        private ?string $cacheDir = null
+    ) {
+    }
+
+    public function isPreloadEnabled(): bool
+    {
+        return $this->preload;
+    }
+
+    public function getDeclarationStorage(): string
+    {
+        return $this->declarationStorage;
+    }
+
+    public function isSplitScopesEnabled(): bool
+    {
+        return $this->splitScopes;
+    }
+
+    public function isDirectDispatchEnabled(): bool
+    {
+        return $this->directDispatch;
+    }
+
+    public function getProfile(): string
+    {
+        return $this->profile;
+    }
+
+    /**
+     * @return array<string>
+     */
+    public function getBatchFunctions(): array
+    {
+        return $this->batchFunctions;
+    }
+
+    public function getStructBackend(): string
+    {
+        return $this->structBackend;
+    }
+
+    public function isOutParamsEnabled(): bool
+    {
+        return $this->outParams;
+    }
+
+    public function isInstrumentEnabled(): bool
+    {
+        return $this->instrument;
+    }
+
+    public function isSharedStatsEnabled(): bool
+    {
+        return $this->sharedStats;
+    }
+
+    public function getJobs(): int
+    {
+        return $this->jobs;
+    }
+
+    public function isPreprocessEnabled(): bool
+    {
+        return $this->preprocess;
+    }
+
+    /**
+     * @return array<string>
+     */
+    public function getDefines(): array
+    {
+        return $this->defines;
+    }
+
+    /**
+     * @return array<string>
+     */
+    public function getIncludePaths(): array
+    {
+        return $this->includePaths;
+    }
+
+    /**
+     * @return string|null Root of the template, preprocessor and include caches, null for the per-user default
+     */
+    public function getCacheDir(): ?string
+    {
+        return $this->cacheDir;
+    }
+
+    public function setPreload(bool $enabled): self
+    {
+        $this->preload = $enabled;
+        return $this;
+    }
+
+    public function setDeclarationStorage(string $declarationStorage): self
+    {
+        if (!in_array($declarationStorage, self::DECLARATION_STORAGES, true)) {
+            throw new ConfigurationException("Invalid declaration storage: {$declarationStorage}. Must be 'constant' or 'file'.");
+        }
+        $this->declarationStorage = $declarationStorage;
+        return $this;
+    }
+
+    public function setSplitScopes(bool $enabled): self
+    {
+        $this->splitScopes = $enabled;
+        return $this;
+    }
+
+    public function setDirectDispatch(bool $enabled): self
+    {
+        $this->directDispatch = $enabled;
+        return $this;
+    }
+
+    public function setProfile(string $profile): self
+    {
+        if (!in_array($profile, self::PROFILES, true)) {
+            throw new ConfigurationException("Invalid profile: {$profile}. Must be 'debug' or 'release'.");
+        }
+        $this->profile = $profile;
+        return $this;
+    }
+
+    /**
+     * @param array<string> $batchFunctions
+     */
+    public function setBatchFunctions(array $batchFunctions): self
+    {
+        $this->batchFunctions = array_values(array_unique($batchFunctions));
+        return $this;
+    }
+
+    public function setStructBackend(string $structBackend): self
+    {
+        if (!in_array($structBackend, self::STRUCT_BACKENDS, true)) {
+            throw new ConfigurationException("Invalid struct backend: {$structBackend}. Must be 'properties' or 'cdata'.");
+        }
+        $this->structBackend = $structBackend;
+        return $this;
+    }
+
+    public function setOutParams(bool $enabled): self
+    {
+        $this->outParams = $enabled;
+        return $this;
+    }
+
+    public function setInstrument(bool $enabled): self
+    {
+        $this->instrument = $enabled;
+        return $this;
+    }
+
+    public function setSharedStats(bool $enabled): self
+    {
+        $this->sharedStats = $enabled;
+        return $this;
+    }
+
+    public function setJobs(int $jobs): self
+    {
+        if ($jobs < 1) {
+            throw new ConfigurationException("Invalid number of jobs: {$jobs}. Must be at least 1.");
+        }
+        $this->jobs = $jobs;
+        return $this;
+    }
+
+    public function setPreprocess(bool $enabled): self
+    {
+        $this->preprocess = $enabled;
+        return $this;
+    }
+
+    /**
+     * @param array<string> $defines Macros as NAME or NAME=VALUE
+     */
+    public function setDefines(array $defines): self
+    {
+        $this->defines = array_values(array_unique($defines));
+        return $this;
+    }
+
+    /**
+     * @param array<string> $includePaths
+     */
+    public function setIncludePaths(array $includePaths): self
+    {
+        $this->includePaths = array_values(array_unique($includePaths));
+        return $this;
+    }
+
+    public function setCacheDir(?string $cacheDir): self
+    {
+        $this->cacheDir = $cacheDir;
+        return $this;
+    }
+
+    /**
+     * @return array<string, mixed>
+     */
+    public function toArray(): array
+    {
+        return [
+            'preload' => $this->preload,
+            'declarationStorage' => $this->declarationStorage,
+            'splitScopes' => $this->splitScopes,
+            'directDispatch' => $this->directDispatch,
+            'profile' => $this->profile,
+            'batchFunctions' => $this->batchFunctions,
+            'structBackend' => $this->structBackend,
+            'outParams' => $this->outParams,
+            'instrument' => $this->instrument,
+            'sharedStats' => $this->sharedStats,
+            'jobs' => $this->jobs,
+            'preprocess' => $this->preprocess,
+            'defines' => $this->defines,
+            'includePaths' => $this->includePaths,
+            'cacheDir' => $this->cacheDir,
+        ];
+    }
+
+    /**
+     * @param array<string, mixed> $data
+     */
+    public static function fromArray(array $data): self
+    {
+        return new self(
+            $data['preload'] ?? false,
+            $data['declarationStorage'] ?? 'constant',
+            $data['splitScopes'] ?? false,
+            $data['directDispatch'] ?? false,
+            $data['profile'] ?? self::PROFILE_DEBUG,
+            $data['batchFunctions'] ?? [],
+            $data['structBackend'] ?? 'properties',
+            $data['outParams'] ?? false,
+            $data['instrument'] ?? false,
+            $data['sharedStats'] ?? false,
+            $data['jobs'] ?? 1,
+            $data['preprocess'] ?? false,
+            $data['defines'] ?? [],
+            $data['includePaths'] ?? [],
+            $data['cacheDir'] ?? null
+        );
+    }
+}
\ No newline at end of file
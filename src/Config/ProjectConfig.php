@@ -22,7 +22,8 @@ class ProjectConfig implements ConfigInterface
         private string $namespace = 'Generated\\FFI',
         private array $excludePatterns = [],
         private ValidationConfig $validation = new ValidationConfig(),
-        private string $generationType = 'object'
+        private string $generationType = 'object',
+        private GenerationConfig $generation = new GenerationConfig()
     ) {
     }
 
@@ -75,6 +76,27 @@ class ProjectConfig implements ConfigInterface
         return $this->generationType;
     }
 
+    public function getGenerationConfig(): GenerationConfig
+    {
+        return $this->generation;
+    }
+
+    /**
+     * Get the path of the compiled batch shim library, next to the generated classes
+     */
+    public function getBatchLibraryFile(): string
+    {
+        return $this->outputPath . '/' . $this->getBatchBaseName() . '.' . PHP_SHLIB_SUFFIX;
+    }
+
+    /**
+     * Get the path of the generated batch shim C source
+     */
+    public function getBatchSourceFile(): string
+    {
+        return $this->outputPath . '/' . $this->getBatchBaseName() . '.c';
+    }
+
     /**
      * @param array<string> $headerFiles
      */
@@ -126,6 +148,12 @@ class ProjectConfig implements ConfigInterface
         return $this;
     }
 
+    public function setGenerationConfig(GenerationConfig $generation): self
+    {
+        $this->generation = $generation;
+        return $this;
+    }
+
     /**
      * @return array<string, mixed>
      */
@@ -139,6 +167,7 @@ class ProjectConfig implements ConfigInterface
             'excludePatterns' => $this->excludePatterns,
             'validation' => $this->validation->toArray(),
             'generationType' => $this->generationType,
+            'generation' => $this->generation->toArray(),
         ];
     }
 
@@ -151,6 +180,10 @@ class ProjectConfig implements ConfigInterface
             ? ValidationConfig::fromArray($data['validation'])
             : new ValidationConfig();
 
+        $generation = isset($data['generation']) && is_array($data['generation'])
+            ? GenerationConfig::fromArray($data['generation'])
+            : new GenerationConfig();
+
         return new self(
             $data['headerFiles'] ?? [],
             $data['libraryFile'] ?? '',
@@ -158,9 +191,15 @@ class ProjectConfig implements ConfigInterface
             $data['namespace'] ?? 'Generated\\FFI',
             $data['excludePatterns'] ?? [],
             $validation,
-            $data['generationType'] ?? 'object'
+            $data['generationType'] ?? 'object',
+            $generation
         );
     }
 
+    private function getBatchBaseName(): string
+    {
+        $name = $this->libraryFile !== '' ? pathinfo($this->libraryFile, PATHINFO_FILENAME) : 'lib';
 
+        return $name . '_batch';
+    }
 }
\ No newline at end of file
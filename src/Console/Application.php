@@ -8,6 +8,9 @@ use Symfony\Component\Console\Application as BaseApplication;
 use Symfony\Component\Console\Input\InputInterface;
 use Symfony\Component\Console\Output\OutputInterface;
 use Yangweijie\CWrapper\Console\Command\GenerateCommand;
+use Yangweijie\CWrapper\Console\Command\RenderWorkerCommand;
+use Yangweijie\CWrapper\Console\Command\StatsCommand;
+use Yangweijie\CWrapper\Console\Command\WarmupCommand;
 
 /**
  * Main console application for C-to-PHP FFI Converter
@@ -23,6 +26,9 @@ class Application extends BaseApplication
         
         $this->addCommands([
             new GenerateCommand(),
+            new StatsCommand(),
+            new WarmupCommand(),
+            new RenderWorkerCommand(),
         ]);
         
         // Set the default command to generate
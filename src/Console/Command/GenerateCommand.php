@@ -12,14 +12,24 @@ use Symfony\Component\Console\Output\OutputInterface;
 use Symfony\Component\Console\Style\SymfonyStyle;
 use Yangweijie\CWrapper\Console\CommandInterface;
 use Yangweijie\CWrapper\Config\ConfigLoader;
+use Yangweijie\CWrapper\Config\ConfigValidator;
 use Yangweijie\CWrapper\Config\ProjectConfig;
 use Yangweijie\CWrapper\Config\ValidationConfig;
 use Yangweijie\CWrapper\Exception\ConfigurationException;
 use Yangweijie\CWrapper\Exception\ValidationException;
 use Yangweijie\CWrapper\Integration\FFIGenIntegration;
 use Yangweijie\CWrapper\Generator\WrapperGenerator;
+use Yangweijie\CWrapper\Generator\BatchShimGenerator;
+use Yangweijie\CWrapper\Generator\DeclarationBuilder;
+use Yangweijie\CWrapper\Generator\GenerationManifest;
+use Yangweijie\CWrapper\Generator\OutputWriter;
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Generator\TemplateEngine;
 use Yangweijie\CWrapper\Analyzer\HeaderAnalyzer;
+use Yangweijie\CWrapper\Analyzer\HeaderPreprocessor;
 use Yangweijie\CWrapper\Analyzer\DependencyResolver;
+use Yangweijie\CWrapper\Analyzer\IncludeCache;
+use Yangweijie\CWrapper\Analyzer\SourceFileRepository;
 
 /**
  * Main command for generating PHP FFI wrapper classes from C projects
@@ -91,6 +101,109 @@ class GenerateCommand extends Command implements CommandInterface
                 'f',
                 InputOption::VALUE_NONE,
                 'Overwrite existing files without confirmation'
+            )
+            ->addOption(
+                'preprocess',
+                null,
+                InputOption::VALUE_NONE,
+                'Analyze headers expanded by the system C preprocessor (cpp -E -dD), cached until a header it read changes'
+            )
+            ->addOption(
+                'define',
+                'D',
+                InputOption::VALUE_IS_ARRAY | InputOption::VALUE_REQUIRED,
+                'Macro passed to the preprocessor as NAME or NAME=VALUE (repeatable, requires --preprocess)',
+                []
+            )
+            ->addOption(
+                'include-path',
+                'I',
+                InputOption::VALUE_IS_ARRAY | InputOption::VALUE_REQUIRED,
+                'Additional include directory for the preprocessor and dependency resolution (repeatable)',
+                []
+            )
+            ->addOption(
+                'jobs',
+                'j',
+                InputOption::VALUE_REQUIRED,
+                'Number of ffigen processes to run concurrently over independent header groups, and of workers rendering the function group classes',
+                '1'
+            )
+            ->addOption(
+                'cache-dir',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Root of the compiled template, preprocessor and include caches, created 0700 (default: $XDG_CACHE_HOME/c-to-php-ffi or ~/.cache/c-to-php-ffi)'
+            )
+            ->addOption(
+                'rebuild',
+                null,
+                InputOption::VALUE_NONE,
+                'Regenerate even if the output manifest shows no relevant change'
+            )
+            ->addOption(
+                'preload',
+                null,
+                InputOption::VALUE_NONE,
+                'Generate an opcache preload script and resolve FFI through FFI::scope()'
+            )
+            ->addOption(
+                'declarations',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Where to embed the C declarations: "constant" in the Bootstrap class or a separate "file"',
+                'constant'
+            )
+            ->addOption(
+                'split-scopes',
+                null,
+                InputOption::VALUE_NONE,
+                'Give each generated class its own lazily loaded FFI scope with only the declarations it needs (struct and pointer values cannot be passed between classes)'
+            )
+            ->addOption(
+                'direct-dispatch',
+                null,
+                InputOption::VALUE_NONE,
+                'Cache the FFI handle in each generated class and call it directly instead of through getFFI()'
+            )
+            ->addOption(
+                'profile',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Wrapper profile: "debug" validates argument types and C integer ranges, "release" emits only the FFI call',
+                'debug'
+            )
+            ->addOption(
+                'batch',
+                null,
+                InputOption::VALUE_IS_ARRAY | InputOption::VALUE_REQUIRED,
+                'Scalar C function to also expose as an array batch method through a compiled C shim (repeatable)',
+                []
+            )
+            ->addOption(
+                'struct-backend',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Struct classes: "properties" copies fields into PHP properties, "cdata" reads and writes the C memory in place',
+                'properties'
+            )
+            ->addOption(
+                'out-params',
+                null,
+                InputOption::VALUE_NONE,
+                'Return values written through scalar out-pointers (e.g. int *out_w) instead of taking CData arguments'
+            )
+            ->addOption(
+                'instrument',
+                null,
+                InputOption::VALUE_NONE,
+                'Record per-function call counts and timings in the Bootstrap profiler (Bootstrap::dumpProfile())'
+            )
+            ->addOption(
+                'shared-stats',
+                null,
+                InputOption::VALUE_NONE,
+                'Also aggregate call counts and latency histograms of all workers in shared memory, read with the stats command (implies --instrument)'
             );
     }
 
@@ -113,7 +226,7 @@ class GenerateCommand extends Command implements CommandInterface
             // Execute the generation process
             $io->section('Generating FFI Wrapper Classes');
             
-            $result = $this->executeGeneration($projectConfig, $io);
+            $result = $this->executeGeneration($projectConfig, $io, (bool) $input->getOption('rebuild'));
             
             if ($result) {
                 $io->success('FFI wrapper classes generated successfully!');
@@ -194,6 +307,83 @@ class GenerateCommand extends Command implements CommandInterface
             $generationType = $input->getOption('type');
             $projectConfig->setGenerationType($generationType);
         }
+
+        // Handle preload option
+        if ($input->getOption('preload')) {
+            $projectConfig->getGenerationConfig()->setPreload(true);
+        }
+
+        // Handle split scopes option
+        if ($input->getOption('split-scopes')) {
+            $projectConfig->getGenerationConfig()->setSplitScopes(true);
+        }
+
+        // Handle direct dispatch option
+        if ($input->getOption('direct-dispatch')) {
+            $projectConfig->getGenerationConfig()->setDirectDispatch(true);
+        }
+
+        // Handle declaration storage option
+        if ($input->hasParameterOption('--declarations')) {
+            $projectConfig->getGenerationConfig()->setDeclarationStorage($input->getOption('declarations'));
+        }
+
+        // Handle batch functions option
+        if ($input->hasParameterOption('--batch')) {
+            $projectConfig->getGenerationConfig()->setBatchFunctions($input->getOption('batch'));
+        }
+
+        // Handle out-parameters option
+        if ($input->getOption('out-params')) {
+            $projectConfig->getGenerationConfig()->setOutParams(true);
+        }
+
+        // Handle instrumentation option
+        if ($input->getOption('instrument')) {
+            $projectConfig->getGenerationConfig()->setInstrument(true);
+        }
+
+        // Handle shared statistics option
+        if ($input->getOption('shared-stats')) {
+            $projectConfig->getGenerationConfig()->setInstrument(true)->setSharedStats(true);
+        }
+
+        // Handle preprocessor options
+        if ($input->getOption('preprocess')) {
+            $projectConfig->getGenerationConfig()->setPreprocess(true);
+        }
+
+        if ($input->hasParameterOption(['--define', '-D'])) {
+            $projectConfig->getGenerationConfig()->setDefines($input->getOption('define'));
+        }
+
+        if ($input->hasParameterOption(['--include-path', '-I'])) {
+            $projectConfig->getGenerationConfig()->setIncludePaths($input->getOption('include-path'));
+        }
+
+        // Handle jobs option
+        if ($input->hasParameterOption(['--jobs', '-j'])) {
+            $jobs = $input->getOption('jobs');
+            if (!ctype_digit((string) $jobs)) {
+                throw new ConfigurationException("Invalid number of jobs: {$jobs}. Must be a positive integer.");
+            }
+            $projectConfig->getGenerationConfig()->setJobs((int) $jobs);
+        }
+
+        // Handle cache directory option
+        if ($input->hasParameterOption('--cache-dir')) {
+            $projectConfig->getGenerationConfig()->setCacheDir($input->getOption('cache-dir'));
+        }
+
+        // Handle struct backend option
+        if ($input->hasParameterOption('--struct-backend')) {
+            $projectConfig->getGenerationConfig()->setStructBackend($input->getOption('struct-backend'));
+        }
+
+        // Handle profile option
+        if ($input->hasParameterOption('--profile')) {
+            $projectConfig->getGenerationConfig()->setProfile($input->getOption('profile'));
+        }
         
         return $projectConfig;
     }
@@ -242,6 +432,9 @@ class GenerateCommand extends Command implements CommandInterface
         if (!preg_match('/^[a-zA-Z_\x7f-\xff][a-zA-Z0-9_\x7f-\xff\\\\]*$/', $namespace)) {
             throw new ValidationException("Invalid namespace format: {$namespace}");
         }
+
+        // Validate that the requested generation modes can be combined
+        (new ConfigValidator())->validateGenerationSettings($projectConfig);
     }
 
     /**
@@ -255,6 +448,8 @@ class GenerateCommand extends Command implements CommandInterface
         $libraryFile = $projectConfig->getLibraryFile();
         $excludePatterns = $projectConfig->getExcludePatterns();
         $validationConfig = $projectConfig->getValidationConfig();
+        $generationConfig = $projectConfig->getGenerationConfig();
+        $batchFunctions = $generationConfig->getBatchFunctions();
 
         $io->section('Configuration Summary');
         
@@ -266,26 +461,70 @@ class GenerateCommand extends Command implements CommandInterface
             ['Generation Type' => ucfirst($projectConfig->getGenerationType())],
             ['Exclude Patterns' => empty($excludePatterns) ? 'None' : implode(', ', $excludePatterns)],
             ['Parameter Validation' => $validationConfig->isParameterValidationEnabled() ? 'Enabled' : 'Disabled'],
-            ['Type Conversion' => $validationConfig->isTypeConversionEnabled() ? 'Enabled' : 'Disabled']
+            ['Type Conversion' => $validationConfig->isTypeConversionEnabled() ? 'Enabled' : 'Disabled'],
+            ['Opcache Preload' => $generationConfig->isPreloadEnabled() ? 'Enabled' : 'Disabled'],
+            ['Declarations' => ucfirst($generationConfig->getDeclarationStorage())],
+            ['FFI Scopes' => $generationConfig->isSplitScopesEnabled() ? 'Per class' : 'Shared'],
+            ['Profile' => ucfirst($generationConfig->getProfile())],
+            ['Struct Backend' => $generationConfig->getStructBackend() === 'cdata' ? 'FFI CData' : 'PHP properties'],
+            ['Out-Parameters' => $generationConfig->isOutParamsEnabled() ? 'Returned' : 'CData arguments'],
+            ['Instrumentation' => $generationConfig->isInstrumentEnabled() ? 'Enabled' : 'Disabled'],
+            ['Shared Statistics' => $generationConfig->isSharedStatsEnabled() ? 'Enabled' : 'Disabled'],
+            ['Preprocessor' => $generationConfig->isPreprocessEnabled() ? 'cpp -E -dD' . implode('', array_map(fn($define) => " -D{$define}", $generationConfig->getDefines())) : 'Disabled'],
+            ['Include Paths' => empty($generationConfig->getIncludePaths()) ? 'None' : implode(', ', $generationConfig->getIncludePaths())],
+            ['Jobs' => (string) $generationConfig->getJobs()],
+            ['Cache Directory' => $generationConfig->getCacheDir() ?? 'Per-user default'],
+            ['Batch Functions' => empty($batchFunctions) ? 'None' : implode(', ', $batchFunctions)],
+            ['Direct Dispatch' => $generationConfig->isDirectDispatchEnabled() ? 'Enabled' : 'Disabled']
         );
     }
 
     /**
      * Execute the actual generation process
+     *
+     * Skips ffigen and generation when the output manifest matches the
+     * current headers, include closure, configuration and generator version.
      */
-    private function executeGeneration(ProjectConfig $projectConfig, SymfonyStyle $io): bool
+    private function executeGeneration(ProjectConfig $projectConfig, SymfonyStyle $io, bool $rebuild = false): bool
     {
         try {
             // Step 1: Analyze header files
             $io->writeln('📋 Analyzing header files...');
-            $headerAnalyzer = new HeaderAnalyzer();
-            $dependencyResolver = new DependencyResolver();
+            // Our stages read headers through one repository, so each is read once by
+            // this process; cpp and ffigen's own parser still read them themselves
+            $sources = new SourceFileRepository();
+            $generationConfig = $projectConfig->getGenerationConfig();
+            $preprocessor = $generationConfig->isPreprocessEnabled()
+                ? new HeaderPreprocessor(
+                    $generationConfig->getDefines(),
+                    $generationConfig->getIncludePaths(),
+                    CacheDirectory::get($generationConfig->getCacheDir(), 'preprocessed'),
+                    sources: $sources
+                )
+                : null;
+            $headerAnalyzer = new HeaderAnalyzer(null, $preprocessor, $sources);
+            $dependencyResolver = new DependencyResolver(
+                [],
+                new IncludeCache(IncludeCache::getProjectFile($projectConfig->getOutputPath(), $generationConfig->getCacheDir())),
+                $sources
+            );
             
-            // Resolve dependencies and create compilation order
+            // Resolve dependencies and create compilation order, from the cached
+            // preprocessor runs when preprocessing so unchanged headers are not walked
             $headerFiles = $projectConfig->getHeaderFiles();
-            $compilationOrder = $dependencyResolver->createCompilationOrder($headerFiles);
+            $compilationOrder = $preprocessor !== null
+                ? $preprocessor->getIncludeClosure($headerFiles)
+                : $dependencyResolver->createCompilationOrder($headerFiles, $generationConfig->getIncludePaths());
             
             $io->writeln(sprintf('   Found %d header files to process', count($compilationOrder)));
+
+            $manifest = new GenerationManifest(null, $sources);
+            $fingerprint = $manifest->createFingerprint($projectConfig, $compilationOrder);
+
+            if (!$rebuild && $manifest->isUpToDate($projectConfig->getOutputPath(), $fingerprint)) {
+                $io->writeln('   ✓ Output is up to date, nothing to generate (use --rebuild to force)');
+                return true;
+            }
             
             // Step 2: Generate FFI bindings using klitsche/ffigen
             $io->writeln('🔧 Generating FFI bindings...');
@@ -302,6 +541,14 @@ class GenerateCommand extends Command implements CommandInterface
             }
             
             $io->writeln('   ✓ FFI bindings generated successfully');
+
+            // Bindings generated in process are returned in memory, the wrappers include them
+            $outputWriter = new OutputWriter();
+            $bindingOutputs = [];
+            foreach ($bindingResult->outputs as $filename => $content) {
+                $outputWriter->write($projectConfig->getOutputPath() . '/' . $filename, $content);
+                $bindingOutputs[] = $filename;
+            }
             
             // Step 3: Process bindings
             $io->writeln('⚙️  Processing bindings...');
@@ -313,19 +560,50 @@ class GenerateCommand extends Command implements CommandInterface
                 count($processedBindings->constants)
             ));
             
-            // Step 4: Generate wrapper classes
-            $io->writeln('🏗️  Generating wrapper classes...');
-            $wrapperGenerator = new WrapperGenerator();
-            
-            $generatedCode = $wrapperGenerator->generate($processedBindings, $projectConfig);
-            
-            $io->writeln(sprintf('   Generated %d wrapper classes', count($generatedCode->classes)));
+            // Step 4: Generate wrapper classes, each file is written as soon as its class is complete
+            $io->writeln('🏗️  Generating and writing wrapper classes...');
+            $wrapperGenerator = new WrapperGenerator(
+                templateEngine: new TemplateEngine(null, CacheDirectory::get($generationConfig->getCacheDir(), 'twig')),
+                declarationBuilder: new DeclarationBuilder($sources),
+                headerAnalyzer: $headerAnalyzer
+            );
             
-            // Step 5: Write generated files
-            $io->writeln('💾 Writing generated files...');
-            $filesWritten = $this->writeGeneratedFiles($generatedCode, $projectConfig, $io);
+            $emitter = $wrapperGenerator->emit($processedBindings, $projectConfig);
+            $outputs = $this->writeGeneratedFiles($emitter, $projectConfig, $io, $outputWriter);
+            $changed = array_keys(array_filter($outputs));
             
-            $io->writeln(sprintf('   ✓ Written %d files', $filesWritten));
+            $io->writeln(sprintf('   Generated %d wrapper classes', $emitter->getReturn()));
+            $io->writeln(sprintf('   ✓ Written %d files, %d unchanged', count($changed), count($outputs) - count($changed)));
+
+            $filesWritten = array_merge(array_keys($outputs), $bindingOutputs);
+
+            // Step 5: Compile the batch shim unless it is newer than its source
+            if (!empty($projectConfig->getGenerationConfig()->getBatchFunctions())) {
+                $batchSource = $projectConfig->getBatchSourceFile();
+                $batchLibrary = $projectConfig->getBatchLibraryFile();
+
+                if (!is_file($batchLibrary) || filemtime($batchLibrary) < filemtime($batchSource)) {
+                    $io->writeln('🔨 Compiling batch shim...');
+                    (new BatchShimGenerator())->compile(
+                        $batchSource,
+                        $batchLibrary,
+                        $projectConfig->getLibraryFile(),
+                        $projectConfig->getHeaderFiles()
+                    );
+                    $io->writeln(sprintf('   ✓ Built %s', basename($batchLibrary)));
+                }
+
+                $filesWritten[] = basename($batchLibrary);
+            }
+
+            // Remove the files of symbols that are no longer generated
+            $previousOutputs = $manifest->read($projectConfig->getOutputPath())['outputs'] ?? [];
+            foreach ($outputWriter->prune($projectConfig->getOutputPath(), $previousOutputs, $filesWritten) as $removed) {
+                $io->writeln("   • Removed stale {$removed}");
+            }
+
+            // Record the inputs of this run for the next incremental check
+            $manifest->write($projectConfig->getOutputPath(), $fingerprint, $filesWritten);
             
             return true;
             
@@ -340,44 +618,38 @@ class GenerateCommand extends Command implements CommandInterface
 
     /**
      * Write generated files to disk
+     *
+     * Files are written as the generator yields them, files whose content
+     * did not change are left untouched.
+     *
+     * @param iterable<string, string> $files Filename relative to the output path => content
+     * @return array<string, bool> Whether each generated file was written, keyed by path relative to the output path
      */
-    private function writeGeneratedFiles($generatedCode, ProjectConfig $projectConfig, SymfonyStyle $io): int
-    {
+    private function writeGeneratedFiles(
+        iterable $files,
+        ProjectConfig $projectConfig,
+        SymfonyStyle $io,
+        OutputWriter $outputWriter
+    ): array {
         $outputPath = $projectConfig->getOutputPath();
-        $filesWritten = 0;
+        $filesWritten = [];
         
         // Ensure output directory exists
         if (!is_dir($outputPath)) {
             mkdir($outputPath, 0755, true);
         }
         
-        // Generate all code files using WrapperGenerator
-        $wrapperGenerator = new WrapperGenerator();
-        $codeFiles = $wrapperGenerator->generateCodeFiles($generatedCode, $projectConfig);
-        
         // Write each generated file
-        foreach ($codeFiles as $filename => $content) {
+        foreach ($files as $filename => $content) {
             $filepath = $outputPath . '/' . $filename;
             
-            file_put_contents($filepath, $content);
-            $filesWritten++;
+            $filesWritten[$filename] = $outputWriter->write($filepath, $content);
             
-            if ($io->isVerbose()) {
+            if ($filesWritten[$filename] && $io->isVerbose()) {
                 $io->writeln("   • $filename");
             }
         }
         
-        // Write documentation if available
-        if (isset($generatedCode->documentation)) {
-            $readmePath = $outputPath . '/README.md';
-            file_put_contents($readmePath, $generatedCode->documentation->readmeContent ?? '# Generated FFI Wrapper Classes');
-            $filesWritten++;
-            
-            if ($io->isVerbose()) {
-                $io->writeln("   • README.md");
-            }
-        }
-        
         return $filesWritten;
     }
 
@@ -0,0 +1,60 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Console\Command;
+
+use Symfony\Component\Console\Command\Command;
+use Symfony\Component\Console\Input\InputArgument;
+use Symfony\Component\Console\Input\InputInterface;
+use Symfony\Component\Console\Output\OutputInterface;
+use Yangweijie\CWrapper\Console\CommandInterface;
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Generator\TemplateEngine;
+use Yangweijie\CWrapper\Generator\WorkerPool;
+use Yangweijie\CWrapper\Generator\WrapperGenerator;
+
+/**
+ * Internal command rendering function group classes for a parallel generate run
+ *
+ * Started by WorkerPool when pcntl is not available.
+ */
+class RenderWorkerCommand extends Command implements CommandInterface
+{
+    protected static $defaultName = 'render-worker';
+    protected static $defaultDescription = 'Render function group classes for a parallel generate run';
+
+    protected function configure(): void
+    {
+        $this
+            ->setName('render-worker')
+            ->setDescription('Render function group classes for a parallel generate run')
+            ->setHidden(true)
+            ->addArgument('payload', InputArgument::REQUIRED, 'Serialized generation plan, configuration and group names')
+            ->addArgument('result', InputArgument::REQUIRED, 'File receiving the serialized rendered classes');
+    }
+
+    public function execute(InputInterface $input, OutputInterface $output): int
+    {
+        $payloadFile = $input->getArgument('payload');
+
+        $succeeded = WorkerPool::writeResult($input->getArgument('result'), function () use ($payloadFile) {
+            $payload = @file_get_contents($payloadFile);
+            $partition = $payload === false ? false : unserialize($payload);
+
+            if (!is_array($partition) || count($partition) !== 3) {
+                throw new GenerationException("Invalid worker payload {$payloadFile}");
+            }
+
+            [$plan, $config, $groupNames] = $partition;
+
+            // Compile templates into the cache of the parent run
+            $templateEngine = new TemplateEngine(null, CacheDirectory::get($config->getGenerationConfig()->getCacheDir(), 'twig'));
+
+            return (new WrapperGenerator(templateEngine: $templateEngine))->renderFunctionGroups($plan, $config, $groupNames);
+        });
+
+        return $succeeded ? Command::SUCCESS : Command::FAILURE;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Console\Command;
+
+use Symfony\Component\Console\Command\Command;
+use Symfony\Component\Console\Input\InputInterface;
+use Symfony\Component\Console\Input\InputOption;
+use Symfony\Component\Console\Output\OutputInterface;
+use Symfony\Component\Console\Style\SymfonyStyle;
+use Yangweijie\CWrapper\Console\CommandInterface;
+use Yangweijie\CWrapper\Profiler\SharedStatsSegment;
+
+/**
+ * Command printing the call statistics shared by wrappers generated with --shared-stats
+ */
+class StatsCommand extends Command implements CommandInterface
+{
+    protected static $defaultName = 'stats';
+    protected static $defaultDescription = 'Show the hottest and slowest C functions recorded by all workers';
+
+    protected function configure(): void
+    {
+        $this
+            ->setName('stats')
+            ->setDescription('Show the hottest and slowest C functions recorded by all workers')
+            ->setHelp(
+                'This command reads the shared memory statistics written by wrappers generated with --shared-stats. Run it as the user of the PHP workers.' . "\n\n"
+                . sprintf('Workers write to %d shards chosen by pid and update them without locks. Two workers of the same shard recording the same function at the same moment can overwrite each other\'s increment, so counts and totals are lower bounds. Under steady load the loss grows with the number of workers per shard and the call rate of a function; rankings stay representative because every worker is counted.', SharedStatsSegment::SHARDS)
+            )
+            ->addOption(
+                'namespace',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'PHP namespace of the generated wrappers, used to derive the segment key',
+                'Generated\\FFI'
+            )
+            ->addOption(
+                'key',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Shared memory key (Bootstrap::STATS_SHM_KEY), overrides --namespace'
+            )
+            ->addOption(
+                'top',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Number of functions to list per table',
+                '10'
+            );
+    }
+
+    public function execute(InputInterface $input, OutputInterface $output): int
+    {
+        $io = new SymfonyStyle($input, $output);
+
+        $key = $input->getOption('key') !== null
+            ? (int) $input->getOption('key')
+            : SharedStatsSegment::keyFor($input->getOption('namespace'));
+        $top = max(1, (int) $input->getOption('top'));
+
+        try {
+            $stats = SharedStatsSegment::read($key);
+        } catch (\RuntimeException $e) {
+            $io->error($e->getMessage());
+            return Command::FAILURE;
+        }
+
+        if ($stats === null) {
+            $io->error(sprintf('No call statistics found for key %d. Were the wrappers generated with --shared-stats and called yet?', $key));
+            return Command::FAILURE;
+        }
+
+        if (empty($stats)) {
+            $io->warning('No calls recorded yet.');
+            return Command::SUCCESS;
+        }
+
+        $io->title('C Function Call Statistics');
+        $io->writeln(sprintf(
+            '%d functions called, %d calls in total',
+            count($stats),
+            array_sum(array_column($stats, 'calls'))
+        ));
+
+        usort($stats, fn($a, $b) => $b['totalNs'] <=> $a['totalNs']);
+        $io->section("Hottest functions (top {$top} by total time)");
+        $this->renderTable($io, array_slice($stats, 0, $top));
+
+        usort($stats, fn($a, $b) => $b['totalNs'] / $b['calls'] <=> $a['totalNs'] / $a['calls']);
+        $io->section("Slowest functions (top {$top} by average latency)");
+        $this->renderTable($io, array_slice($stats, 0, $top));
+
+        return Command::SUCCESS;
+    }
+
+    /**
+     * Render a statistics table
+     *
+     * @param SymfonyStyle $io Console style
+     * @param array<array{function: string, calls: int, totalNs: int, maxNs: int, histogram: array<int>}> $stats Function statistics
+     */
+    private function renderTable(SymfonyStyle $io, array $stats): void
+    {
+        $rows = [];
+
+        foreach ($stats as $stat) {
+            $rows[] = [
+                $stat['function'],
+                number_format($stat['calls']),
+                number_format($stat['totalNs'] / 1e6, 2),
+                $this->formatNs((int) ($stat['totalNs'] / $stat['calls'])),
+                $this->formatBound(SharedStatsSegment::percentile($stat['histogram'], 50)),
+                $this->formatBound(SharedStatsSegment::percentile($stat['histogram'], 99)),
+                $this->formatNs($stat['maxNs']),
+            ];
+        }
+
+        $io->table(['Function', 'Calls', 'Total ms', 'Avg', 'p50', 'p99', 'Max'], $rows);
+    }
+
+    /**
+     * Format a percentile bucket bound
+     *
+     * @param int|null $boundNs Upper bound in nanoseconds, null for the open-ended bucket
+     * @return string Formatted bound
+     */
+    private function formatBound(?int $boundNs): string
+    {
+        if ($boundNs === null) {
+            return '>' . $this->formatNs(SharedStatsSegment::getBucketUpperBoundNs(SharedStatsSegment::BUCKETS - 2));
+        }
+
+        return '<' . $this->formatNs($boundNs);
+    }
+
+    /**
+     * Format a duration
+     *
+     * @param int $ns Duration in nanoseconds
+     * @return string Human readable duration
+     */
+    private function formatNs(int $ns): string
+    {
+        if ($ns >= 1000000) {
+            return number_format($ns / 1e6, 2) . ' ms';
+        }
+
+        if ($ns >= 1000) {
+            return number_format($ns / 1e3, 1) . ' µs';
+        }
+
+        return $ns . ' ns';
+    }
+}
\ No newline at end of file
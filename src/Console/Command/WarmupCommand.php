@@ -0,0 +1,59 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Console\Command;
+
+use Symfony\Component\Console\Command\Command;
+use Symfony\Component\Console\Input\InputInterface;
+use Symfony\Component\Console\Input\InputOption;
+use Symfony\Component\Console\Output\OutputInterface;
+use Symfony\Component\Console\Style\SymfonyStyle;
+use Yangweijie\CWrapper\Console\CommandInterface;
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Generator\TemplateEngine;
+
+/**
+ * Command compiling the default code templates into the template cache
+ */
+class WarmupCommand extends Command implements CommandInterface
+{
+    protected static $defaultName = 'warmup';
+    protected static $defaultDescription = 'Precompile the default code templates';
+
+    protected function configure(): void
+    {
+        $this
+            ->setName('warmup')
+            ->setDescription('Precompile the default code templates')
+            ->setHelp('This command compiles the default Twig templates into the twig directory of the cache root generate uses, so the first generate run does not compile them. Run it after installing or upgrading, with the same --cache-dir as generate.')
+            ->addOption(
+                'cache-dir',
+                null,
+                InputOption::VALUE_REQUIRED,
+                'Cache root directory, created 0700 (default: $XDG_CACHE_HOME/c-to-php-ffi or ~/.cache/c-to-php-ffi)'
+            );
+    }
+
+    public function execute(InputInterface $input, OutputInterface $output): int
+    {
+        $io = new SymfonyStyle($input, $output);
+
+        try {
+            $cacheDir = CacheDirectory::get($input->getOption('cache-dir'), 'twig');
+            $templates = (new TemplateEngine(null, $cacheDir))->warmup();
+        } catch (GenerationException $e) {
+            $io->error($e->getMessage());
+            return Command::FAILURE;
+        }
+
+        if ($io->isVerbose()) {
+            $io->listing($templates);
+        }
+
+        $io->success(sprintf('Compiled %d templates into %s', count($templates), $cacheDir));
+
+        return Command::SUCCESS;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Symfony\Component\Process\Process;
+use Yangweijie\CWrapper\Analyzer\FunctionSignature;
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Generates and compiles the companion C library with batch loops
+ *
+ * For a scalar function R fn(T a, T b, ...) the shim exports
+ * void fn_batch(const T *in, R *out, size_t n), which calls fn once per row of
+ * the row-major input so a whole array crosses the FFI boundary in one call.
+ */
+class BatchShimGenerator
+{
+    public const SUFFIX = '_batch';
+
+    /**
+     * C scalar types FFI can pass as plain arrays without extra declarations
+     *
+     * Character types are left out: FFI does not assign PHP ints to char elements.
+     */
+    private const SCALAR_TYPES = [
+        'short', 'unsigned short',
+        'int', 'unsigned int',
+        'long', 'unsigned long',
+        'long long', 'unsigned long long',
+        'float', 'double',
+        'int8_t', 'int16_t', 'int32_t', 'int64_t',
+        'uint8_t', 'uint16_t', 'uint32_t', 'uint64_t',
+        'size_t',
+    ];
+
+    /**
+     * Check whether a function can be batched
+     *
+     * All parameters must share one scalar type and the return type must be scalar.
+     *
+     * @param FunctionSignature $function Function signature
+     * @return bool True if a batch loop can be generated
+     */
+    public function isBatchable(FunctionSignature $function): bool
+    {
+        if (empty($function->parameters) || !$this->isScalarType($function->returnType)) {
+            return false;
+        }
+
+        $inputType = $this->getInputType($function);
+
+        foreach ($function->parameters as $param) {
+            if (!$this->isScalarType($param['type']) || $this->normalizeType($param['type']) !== $inputType) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Get the element type of the batch input array
+     *
+     * @param FunctionSignature $function Batchable function signature
+     * @return string C scalar type
+     */
+    public function getInputType(FunctionSignature $function): string
+    {
+        return $this->normalizeType($function->parameters[0]['type']);
+    }
+
+    /**
+     * Get the element type of the batch output array
+     *
+     * @param FunctionSignature $function Batchable function signature
+     * @return string C scalar type
+     */
+    public function getOutputType(FunctionSignature $function): string
+    {
+        return $this->normalizeType($function->returnType);
+    }
+
+    /**
+     * Generate the C source of the shim library
+     *
+     * @param array<FunctionSignature> $functions Batchable functions
+     * @param array<string> $headerFiles Headers declaring the wrapped functions
+     * @return string C source code
+     */
+    public function generateSource(array $functions, array $headerFiles): string
+    {
+        $source = "/* Generated by C-to-PHP FFI Converter, do not edit */\n\n";
+        $source .= "#include <stddef.h>\n";
+        $source .= "#include <stdint.h>\n";
+
+        foreach ($headerFiles as $headerFile) {
+            $source .= '#include "' . addslashes(realpath($headerFile) ?: $headerFile) . "\"\n";
+        }
+
+        foreach ($functions as $function) {
+            $arity = count($function->parameters);
+            $arguments = [];
+
+            for ($i = 0; $i < $arity; $i++) {
+                $arguments[] = $arity === 1 ? 'in[i]' : "in[i * {$arity} + {$i}]";
+            }
+
+            $source .= "\n" . $this->generatePrototype($function) . "\n";
+            $source .= "{\n";
+            $source .= "    for (size_t i = 0; i < n; i++) {\n";
+            $source .= "        out[i] = {$function->name}(" . implode(', ', $arguments) . ");\n";
+            $source .= "    }\n";
+            $source .= "}\n";
+        }
+
+        return $source;
+    }
+
+    /**
+     * Generate the declarations of the batch functions for FFI::cdef()
+     *
+     * @param array<FunctionSignature> $functions Batchable functions
+     * @return string C declarations
+     */
+    public function generateDeclarations(array $functions): string
+    {
+        $declarations = [];
+
+        foreach ($functions as $function) {
+            $declarations[] = $this->generatePrototype($function) . ';';
+        }
+
+        return implode("\n", $declarations);
+    }
+
+    /**
+     * Compile the shim library with the local C compiler
+     *
+     * The compiler is taken from the CC environment variable, "cc" by default.
+     *
+     * @param string $sourceFile Shim C source file
+     * @param string $outputFile Shared library to produce
+     * @param string $libraryFile Wrapped library the shim links against
+     * @param array<string> $headerFiles Headers whose directories are added to the include path
+     * @throws GenerationException If compilation fails
+     */
+    public function compile(string $sourceFile, string $outputFile, string $libraryFile, array $headerFiles): void
+    {
+        $command = [getenv('CC') ?: 'cc', '-shared', '-fPIC', '-O2', '-o', $outputFile, $sourceFile];
+
+        foreach (array_unique(array_map('dirname', $headerFiles)) as $includeDir) {
+            $command[] = '-I' . $includeDir;
+        }
+
+        if ($libraryFile !== '') {
+            $command[] = $libraryFile;
+            $command[] = '-Wl,-rpath,' . dirname(realpath($libraryFile) ?: $libraryFile);
+        }
+
+        $process = new Process($command);
+        $process->run();
+
+        if (!$process->isSuccessful()) {
+            throw new GenerationException(
+                "Failed to compile batch shim {$sourceFile}: " . trim($process->getErrorOutput() ?: $process->getOutput())
+            );
+        }
+    }
+
+    /**
+     * Generate the prototype of a batch function
+     *
+     * @param FunctionSignature $function Batchable function signature
+     * @return string C prototype without trailing semicolon
+     */
+    private function generatePrototype(FunctionSignature $function): string
+    {
+        return sprintf(
+            'void %s%s(const %s *in, %s *out, size_t n)',
+            $function->name,
+            self::SUFFIX,
+            $this->getInputType($function),
+            $this->getOutputType($function)
+        );
+    }
+
+    /**
+     * Check if a C type is a supported scalar
+     *
+     * @param string $cType C type
+     * @return bool True for scalar types
+     */
+    private function isScalarType(string $cType): bool
+    {
+        return in_array($this->normalizeType($cType), self::SCALAR_TYPES, true);
+    }
+
+    /**
+     * Normalize whitespace and drop top-level const from a C type
+     *
+     * @param string $cType C type
+     * @return string Normalized type
+     */
+    private function normalizeType(string $cType): string
+    {
+        $type = preg_replace('/\s+/', ' ', trim($cType));
+
+        return preg_replace('/^const /', '', $type);
+    }
+}
\ No newline at end of file
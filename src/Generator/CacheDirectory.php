@@ -0,0 +1,104 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Locates the private directory holding the persistent caches
+ *
+ * Compiled templates, preprocessed headers and include lists are code or
+ * data the generator trusts, so they live in a directory only the current
+ * user can write: $XDG_CACHE_HOME/c-to-php-ffi, ~/.cache/c-to-php-ffi or
+ * %LOCALAPPDATA%\c-to-php-ffi, and a per-user directory in the temp
+ * directory when none of these is usable. Directories are created 0700;
+ * an existing one owned by another user is refused.
+ */
+class CacheDirectory
+{
+    private const NAME = 'c-to-php-ffi';
+
+    /**
+     * Get a cache directory, creating it if needed
+     *
+     * @param string|null $root Cache root, the per-user default when null
+     * @param string $name Subdirectory for one kind of cache, empty for the root itself
+     * @return string Directory path
+     * @throws GenerationException If the directory cannot be created or is writable by others
+     */
+    public static function get(?string $root = null, string $name = ''): string
+    {
+        $roots = $root !== null && $root !== '' ? [$root] : self::getDefaultRoots();
+        $error = null;
+
+        foreach ($roots as $candidate) {
+            $directory = rtrim($candidate, '/\\') . ($name !== '' ? DIRECTORY_SEPARATOR . $name : '');
+
+            try {
+                self::ensurePrivate($candidate);
+                self::ensurePrivate($directory);
+                return $directory;
+            } catch (GenerationException $e) {
+                $error = $e;
+            }
+        }
+
+        throw $error;
+    }
+
+    /**
+     * Get the default cache roots in order of preference
+     *
+     * @return array<string>
+     */
+    private static function getDefaultRoots(): array
+    {
+        $roots = [];
+
+        if ($xdg = getenv('XDG_CACHE_HOME')) {
+            $roots[] = $xdg . '/' . self::NAME;
+        }
+
+        if ($home = getenv('HOME')) {
+            $roots[] = $home . '/.cache/' . self::NAME;
+        }
+
+        if ($localAppData = getenv('LOCALAPPDATA')) {
+            $roots[] = $localAppData . DIRECTORY_SEPARATOR . self::NAME;
+        }
+
+        $user = function_exists('posix_geteuid') ? (string) posix_geteuid() : get_current_user();
+        $roots[] = sys_get_temp_dir() . DIRECTORY_SEPARATOR . self::NAME . '-' . $user;
+
+        return $roots;
+    }
+
+    /**
+     * Create a directory readable by the current user only, or check an existing one
+     *
+     * @param string $directory Directory path
+     * @throws GenerationException If the directory cannot be created or is not private
+     */
+    private static function ensurePrivate(string $directory): void
+    {
+        if (!is_dir($directory) && !@mkdir($directory, 0700, true) && !is_dir($directory)) {
+            throw new GenerationException("Failed to create cache directory: {$directory}");
+        }
+
+        // Ownership and modes are not meaningful on Windows
+        if (!function_exists('posix_geteuid')) {
+            return;
+        }
+
+        $stat = @stat($directory);
+        if ($stat === false || $stat['uid'] !== posix_geteuid()) {
+            throw new GenerationException("Cache directory is owned by another user: {$directory}");
+        }
+
+        if (($stat['mode'] & 0077) !== 0 && !@chmod($directory, 0700)) {
+            throw new GenerationException("Cache directory is accessible by other users: {$directory}");
+        }
+    }
+}
\ No newline at end of file
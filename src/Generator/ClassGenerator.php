@@ -6,6 +6,7 @@ namespace Yangweijie\CWrapper\Generator;
 
 use Yangweijie\CWrapper\Analyzer\FunctionSignature;
 use Yangweijie\CWrapper\Analyzer\StructureDefinition;
+use Yangweijie\CWrapper\Config\GenerationConfig;
 
 /**
  * Generates PHP wrapper classes from C function groups
@@ -30,6 +31,10 @@ class ClassGenerator
      * @param array<StructureDefinition> $structures Structures to include as properties
      * @param array<string, mixed> $constants Constants to include in the class
      * @param string $generationType Generation type: 'object' or 'functional'
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
      * @return WrapperClass Generated wrapper class
      */
     public function generateClass(
@@ -38,7 +43,11 @@ class ClassGenerator
         array $functions,
         array $structures = [],
         array $constants = [],
-        string $generationType = 'object'
+        string $generationType = 'object',
+        bool $directDispatch = false,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $outParams = false,
+        bool $instrument = false
     ): WrapperClass {
         $methods = [];
         $properties = [];
@@ -46,7 +55,15 @@ class ClassGenerator
 
         // Generate methods from functions
         foreach ($functions as $function) {
-            $methods[] = $this->methodGenerator->generateMethod($function, $generationType, $className);
+            $methods[] = $this->methodGenerator->generateMethod(
+                $function,
+                $generationType,
+                $className,
+                $directDispatch,
+                $profile,
+                $outParams,
+                $instrument
+            );
         }
 
         // Generate properties from structures
@@ -92,11 +109,12 @@ class ClassGenerator
      *
      * @param WrapperClass $wrapperClass Wrapper class to generate code for
      * @param string $libraryPath Path to the C library
+     * @param string|null $ffiAccessor Custom getFFI() method code, null to delegate to Bootstrap
      * @return string Complete PHP class code
      */
-    public function generateClassCode(WrapperClass $wrapperClass, string $libraryPath): string
+    public function generateClassCode(WrapperClass $wrapperClass, string $libraryPath, ?string $ffiAccessor = null): string
     {
-        return $this->templateEngine->renderWrapperClass($wrapperClass, $libraryPath);
+        return $this->templateEngine->renderWrapperClass($wrapperClass, $libraryPath, $ffiAccessor);
     }
 
     /**
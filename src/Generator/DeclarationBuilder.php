@@ -0,0 +1,515 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Yangweijie\CWrapper\Analyzer\SourceFileRepository;
+use Yangweijie\CWrapper\Exception\AnalysisException;
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Builds C declarations that can be handed to FFI::cdef() or FFI::load()
+ *
+ * The FFI parser understands neither comments in every position nor any
+ * preprocessor directive besides FFI_SCOPE/FFI_LIB, so header content is
+ * reduced to plain declarations here.
+ */
+class DeclarationBuilder
+{
+    /**
+     * Maximum number of macro substitution passes
+     */
+    private const MAX_MACRO_PASSES = 8;
+
+    /**
+     * Tokens that look like calls but never name a declared function
+     */
+    private const NON_FUNCTION_TOKENS = ['__attribute__', '__declspec', '__asm__', 'asm', 'sizeof'];
+
+    private SourceFileRepository $sources;
+
+    /**
+     * @param SourceFileRepository|null $sources Header contents shared with the other stages
+     */
+    public function __construct(?SourceFileRepository $sources = null)
+    {
+        $this->sources = $sources ?? new SourceFileRepository();
+    }
+
+    /**
+     * Build declarations from a list of header files
+     *
+     * @param array<string> $headerFiles Header files to read
+     * @param array<string> $exportedSymbols Function names to keep, empty to keep all
+     * @return string Cleaned C declarations
+     * @throws GenerationException If a header file cannot be read
+     */
+    public function build(array $headerFiles, array $exportedSymbols = []): string
+    {
+        return $this->render($this->filter($this->collect($headerFiles), $exportedSymbols));
+    }
+
+    /**
+     * Parse all declarations from a list of header files
+     *
+     * @param array<string> $headerFiles Header files to read
+     * @return array<array{kind: string, name: string, code: string}> Declarations in source order
+     * @throws GenerationException If a header file cannot be read
+     */
+    public function collect(array $headerFiles): array
+    {
+        $declarations = [];
+
+        foreach ($headerFiles as $headerFile) {
+            foreach ($this->parse($this->readHeader($headerFile)) as $declaration) {
+                $declarations[] = $declaration;
+            }
+        }
+
+        return $declarations;
+    }
+
+    /**
+     * Select the given functions plus the transitive closure of types they use
+     *
+     * @param array<array{kind: string, name: string, code: string}> $declarations Parsed declarations
+     * @param array<string> $functionNames Functions to keep
+     * @return array<array{kind: string, name: string, code: string}> Minimal declarations in source order
+     */
+    public function slice(array $declarations, array $functionNames): array
+    {
+        $typeIndex = [];
+        foreach ($declarations as $index => $declaration) {
+            if ($declaration['kind'] === 'type' && $declaration['name'] !== '') {
+                $typeIndex[$declaration['name']][] = $index;
+            }
+        }
+
+        $wanted = array_flip($functionNames);
+        $selected = [];
+        $queue = [];
+
+        foreach ($declarations as $index => $declaration) {
+            if ($declaration['kind'] === 'function' && isset($wanted[$declaration['name']])) {
+                $selected[$index] = true;
+                $queue[] = $index;
+            }
+        }
+
+        while (!empty($queue)) {
+            $index = array_pop($queue);
+
+            foreach ($this->extractTypeReferences($declarations[$index]['code']) as $reference) {
+                foreach ($typeIndex[$reference] ?? [] as $typeIndexEntry) {
+                    if (!isset($selected[$typeIndexEntry])) {
+                        $selected[$typeIndexEntry] = true;
+                        $queue[] = $typeIndexEntry;
+                    }
+                }
+            }
+        }
+
+        // Keep source order so every type is declared before it is used
+        ksort($selected);
+
+        return $this->filter(array_values(array_intersect_key($declarations, $selected)), []);
+    }
+
+    /**
+     * Build a header suitable for FFI::load() with FFI_SCOPE and FFI_LIB defines
+     *
+     * @param string $declarations Declarations returned by build()
+     * @param string $scope FFI scope name
+     * @param string $libraryPath Shared library path
+     * @return string Header content
+     */
+    public function buildScopeHeader(string $declarations, string $scope, string $libraryPath): string
+    {
+        $header = "#define FFI_SCOPE \"{$scope}\"\n";
+
+        if ($libraryPath !== '') {
+            $header .= "#define FFI_LIB \"{$libraryPath}\"\n";
+        }
+
+        return $header . "\n" . $declarations;
+    }
+
+    /**
+     * Parse header content into top-level declarations
+     *
+     * @param string $content Raw header content
+     * @return array<array{kind: string, name: string, code: string}> Declarations in source order
+     */
+    public function parse(string $content): array
+    {
+        $declarations = [];
+
+        foreach ($this->splitDeclarations($this->clean($content)) as $code) {
+            $declaration = $this->classify($code);
+            if ($declaration !== null) {
+                $declarations[] = $declaration;
+            }
+        }
+
+        return $declarations;
+    }
+
+    /**
+     * Strip comments, preprocessor directives and C++ linkage blocks
+     *
+     * Object-like macros are substituted before the directives are removed so
+     * export markers and array size constants do not leak into the result.
+     *
+     * @param string $content Raw header content
+     * @return string Cleaned declarations
+     */
+    public function clean(string $content): string
+    {
+        // Join continued lines so multi-line macros are dropped as a whole
+        $content = preg_replace('/\\\\\r?\n/', ' ', $content);
+
+        // Remove comments
+        $content = preg_replace('/\/\*.*?\*\//s', '', $content);
+        $content = preg_replace('/\/\/[^\n]*/', '', $content);
+
+        $macros = $this->extractObjectMacros($content);
+
+        // Remove preprocessor directives (include guards, includes, macros)
+        $content = preg_replace('/^[ \t]*#[^\n]*$/m', '', $content);
+
+        $content = $this->substituteMacros($content, $macros);
+
+        // Remove extern "C" wrappers, the matching brace is dropped below
+        $content = preg_replace('/extern\s+"C"\s*\{/', '', $content);
+        $content = $this->dropUnbalancedBraces($content);
+
+        // Normalize blank lines and trailing whitespace
+        $content = preg_replace('/[ \t]+$/m', '', $content);
+        $content = preg_replace('/\n{3,}/', "\n\n", $content);
+
+        return trim($content);
+    }
+
+    /**
+     * Keep type declarations and the exported function prototypes
+     *
+     * @param array<array{kind: string, name: string, code: string}> $declarations Parsed declarations
+     * @param array<string> $exportedSymbols Function names to keep, empty to keep all
+     * @return array<array{kind: string, name: string, code: string}> Filtered declarations
+     */
+    public function filter(array $declarations, array $exportedSymbols): array
+    {
+        $exported = array_flip($exportedSymbols);
+        $filtered = [];
+        $seen = [];
+
+        foreach ($declarations as $declaration) {
+            if ($declaration['kind'] !== 'type' && !empty($exported) && !isset($exported[$declaration['name']])) {
+                continue;
+            }
+
+            // The same header may be reached through several input files
+            if (isset($seen[$declaration['code']])) {
+                continue;
+            }
+
+            $seen[$declaration['code']] = true;
+            $filtered[] = $declaration;
+        }
+
+        return $filtered;
+    }
+
+    /**
+     * Render declarations back into C source
+     *
+     * @param array<array{kind: string, name: string, code: string}> $declarations Declarations to render
+     * @return string C source
+     */
+    public function render(array $declarations): string
+    {
+        if (empty($declarations)) {
+            return '';
+        }
+
+        return implode("\n", array_column($declarations, 'code')) . "\n";
+    }
+
+    /**
+     * Read a header file through the source repository
+     *
+     * @throws GenerationException If the file cannot be read
+     */
+    private function readHeader(string $headerFile): string
+    {
+        try {
+            return $this->sources->get($headerFile)->content;
+        } catch (AnalysisException $e) {
+            throw new GenerationException($e->getMessage(), 0, $e);
+        }
+    }
+
+    /**
+     * Collect object-like macro definitions
+     *
+     * @return array<string, string> Macro name => replacement
+     */
+    private function extractObjectMacros(string $content): array
+    {
+        $macros = [];
+
+        if (preg_match_all('/^[ \t]*#[ \t]*define[ \t]+([A-Za-z_]\w*)(?:[ \t]+([^\n]*))?$/m', $content, $matches, PREG_SET_ORDER)) {
+            foreach ($matches as $match) {
+                $body = trim($match[2] ?? '');
+
+                // Skip self-referencing macros, they would never settle
+                if (preg_match('/\b' . preg_quote($match[1], '/') . '\b/', $body)) {
+                    continue;
+                }
+
+                $macros[$match[1]] = $body;
+            }
+        }
+
+        return $macros;
+    }
+
+    /**
+     * Replace object-like macro names in declarations
+     *
+     * @param array<string, string> $macros Macro name => replacement
+     */
+    private function substituteMacros(string $content, array $macros): string
+    {
+        if (empty($macros)) {
+            return $content;
+        }
+
+        for ($pass = 0; $pass < self::MAX_MACRO_PASSES; $pass++) {
+            $replaced = false;
+            $content = preg_replace_callback('/\b[A-Za-z_]\w*\b/', function (array $match) use ($macros, &$replaced): string {
+                if (!array_key_exists($match[0], $macros)) {
+                    return $match[0];
+                }
+
+                $replaced = true;
+                return $macros[$match[0]];
+            }, $content);
+
+            if (!$replaced) {
+                break;
+            }
+        }
+
+        return $content;
+    }
+
+    /**
+     * Split cleaned content into top-level declarations
+     *
+     * @return array<string>
+     */
+    private function splitDeclarations(string $content): array
+    {
+        $declarations = [];
+        $current = '';
+        $braces = 0;
+        $parens = 0;
+        $length = strlen($content);
+
+        for ($i = 0; $i < $length; $i++) {
+            $char = $content[$i];
+            $current .= $char;
+
+            if ($char === '(') {
+                $parens++;
+            } elseif ($char === ')') {
+                $parens--;
+            } elseif ($char === '{') {
+                $braces++;
+            } elseif ($char === '}') {
+                $braces--;
+
+                // Inline function definitions end without a semicolon
+                if ($braces === 0 && $this->isFunctionDefinition($current)) {
+                    $declarations[] = trim($current);
+                    $current = '';
+                }
+            } elseif ($char === ';' && $braces === 0 && $parens === 0) {
+                $declarations[] = trim($current);
+                $current = '';
+            }
+        }
+
+        if (trim($current) !== '') {
+            $declarations[] = trim($current);
+        }
+
+        return $declarations;
+    }
+
+    /**
+     * Classify a declaration
+     *
+     * @return array{kind: string, name: string, code: string}|null Null for declarations FFI cannot use
+     */
+    private function classify(string $code): ?array
+    {
+        if ($code === ';' || $code === '') {
+            return null;
+        }
+
+        // Function bodies cannot be declared through FFI
+        if ($this->isFunctionDefinition($code)) {
+            return null;
+        }
+
+        if (preg_match('/^typedef\b/', $code)) {
+            return ['kind' => 'type', 'name' => $this->extractTypedefName($code), 'code' => $code];
+        }
+
+        if (preg_match('/^(struct|union|enum)\s+(\w+)?\s*(\{|;)/', $code, $matches)) {
+            $name = isset($matches[2]) && $matches[2] !== '' ? "{$matches[1]} {$matches[2]}" : '';
+            return ['kind' => 'type', 'name' => $name, 'code' => $code];
+        }
+
+        $functionName = $this->extractFunctionName($code);
+        if ($functionName !== null) {
+            return ['kind' => 'function', 'name' => $functionName, 'code' => $code];
+        }
+
+        if (preg_match('/(\w+)\s*(?:\[[^\]]*\])*\s*;$/', $code, $matches)) {
+            return ['kind' => 'variable', 'name' => $matches[1], 'code' => $code];
+        }
+
+        return null;
+    }
+
+    /**
+     * Extract identifiers and tagged type names a declaration refers to
+     *
+     * @return array<string> Names such as "uiControl" or "struct uiControl"
+     */
+    private function extractTypeReferences(string $code): array
+    {
+        $references = [];
+
+        if (preg_match_all('/\b(?:(struct|union|enum)\s+)?([A-Za-z_]\w*)/', $code, $matches, PREG_SET_ORDER)) {
+            foreach ($matches as $match) {
+                $references[$match[1] !== '' ? "{$match[1]} {$match[2]}" : $match[2]] = true;
+            }
+        }
+
+        return array_keys($references);
+    }
+
+    /**
+     * Check whether a declaration is a function definition with a body
+     */
+    private function isFunctionDefinition(string $code): bool
+    {
+        $bracePosition = strpos($code, '{');
+        if ($bracePosition === false) {
+            return false;
+        }
+
+        return str_ends_with(rtrim(substr($code, 0, $bracePosition)), ')');
+    }
+
+    /**
+     * Extract the name introduced by a typedef
+     */
+    private function extractTypedefName(string $code): string
+    {
+        // Function pointer typedef: typedef void (*name)(...);
+        if (preg_match('/\(\s*\*\s*(\w+)\s*\)\s*\(/', $code, $matches)) {
+            return $matches[1];
+        }
+
+        if (preg_match('/(\w+)\s*(?:\[[^\]]*\])*\s*;$/', $code, $matches)) {
+            return $matches[1];
+        }
+
+        return '';
+    }
+
+    /**
+     * Extract the declared function name from a prototype
+     */
+    private function extractFunctionName(string $code): ?string
+    {
+        $code = $this->stripAttributes($code);
+
+        if (!preg_match_all('/([A-Za-z_]\w*)\s*\(/', $code, $matches, PREG_OFFSET_CAPTURE)) {
+            return null;
+        }
+
+        foreach ($matches[1] as [$name, $offset]) {
+            if (in_array($name, self::NON_FUNCTION_TOKENS, true)) {
+                continue;
+            }
+
+            // "(*name)(" declares a function pointer variable, not a function
+            $before = rtrim(substr($code, 0, $offset));
+            if (str_ends_with($before, '*') && str_contains($before, '(')) {
+                return null;
+            }
+
+            return $name;
+        }
+
+        return null;
+    }
+
+    /**
+     * Remove __attribute__((...)) and __declspec(...) groups
+     */
+    private function stripAttributes(string $code): string
+    {
+        while (preg_match('/\b(?:__attribute__|__declspec)\s*\(/', $code, $matches, PREG_OFFSET_CAPTURE)) {
+            $start = $matches[0][1];
+            $depth = 0;
+            $length = strlen($code);
+
+            for ($i = $start + strlen($matches[0][0]) - 1; $i < $length; $i++) {
+                if ($code[$i] === '(') {
+                    $depth++;
+                } elseif ($code[$i] === ')' && --$depth === 0) {
+                    break;
+                }
+            }
+
+            $code = substr($code, 0, $start) . substr($code, $i + 1);
+        }
+
+        return $code;
+    }
+
+    /**
+     * Remove closing braces that have no matching opening brace
+     */
+    private function dropUnbalancedBraces(string $content): string
+    {
+        $result = '';
+        $depth = 0;
+        $length = strlen($content);
+
+        for ($i = 0; $i < $length; $i++) {
+            $char = $content[$i];
+
+            if ($char === '{') {
+                $depth++;
+            } elseif ($char === '}') {
+                if ($depth === 0) {
+                    continue;
+                }
+                $depth--;
+            }
+
+            $result .= $char;
+        }
+
+        return $result;
+    }
+}
\ No newline at end of file
@@ -9,11 +9,16 @@ namespace Yangweijie\CWrapper\Generator;
  */
 class FFIGenOutputParser
 {
+    /**
+     * Doc comments and method headers of a Methods.php trait, matched in one scan
+     */
+    private const BINDING_PATTERN = '/\/\*\*(?:(?!\*\/).)*\*\/|public\s+static\s+function\s+(\w+)\s*\(([^)]*)\)(?:\s*:\s*([^{;]+))?\s*\{/s';
+
     /**
      * Parse Methods.php file to extract function information with correct types
      *
      * @param string $methodsFilePath Path to the generated Methods.php file
-     * @return array<string, array{name: string, returnType: string, parameters: array, rawMethod: string}>
+     * @return array<string, array{name: string, returnType: string, parameters: array, docComment: array, documentation: array<string>, rawMethod: string}>
      */
     public function parseMethodsFile(string $methodsFilePath): array
     {
@@ -21,36 +26,81 @@ class FFIGenOutputParser
             return [];
         }
 
-        $content = file_get_contents($methodsFilePath);
+        return $this->parseBindings((string) file_get_contents($methodsFilePath))['functions'];
+    }
+
+    /**
+     * Parse the functions and struct names of a Methods.php trait in a single pass
+     *
+     * Each doc comment is attached to the method header directly following
+     * it; doc comments naming a struct contribute the struct name.
+     *
+     * @param string $content Methods.php content
+     * @return array{functions: array<string, array{name: string, returnType: string, parameters: array, docComment: array, documentation: array<string>, rawMethod: string}>, structures: array<string>}
+     */
+    public function parseBindings(string $content): array
+    {
         $functions = [];
+        $structures = [];
+        $docComment = null;
+        $docEnd = 0;
 
-        // Extract function definitions using regex
-        $pattern = '/\/\*\*\s*\n(.*?)\*\/\s*\n\s*public static function (\w+)\((.*?)\)(?::\s*([^{]+))?\s*\{/s';
-        
-        if (preg_match_all($pattern, $content, $matches, PREG_SET_ORDER)) {
-            foreach ($matches as $match) {
-                $docComment = $match[1];
-                $functionName = $match[2];
-                $parametersString = $match[3];
-                $returnType = isset($match[4]) ? trim($match[4]) : 'void';
-
-                // Parse parameters
-                $parameters = $this->parseParameters($parametersString);
-                
-                // Parse doc comment for additional type info
-                $docInfo = $this->parseDocComment($docComment);
-
-                $functions[$functionName] = [
-                    'name' => $functionName,
-                    'returnType' => $returnType,
-                    'parameters' => $parameters,
-                    'docComment' => $docInfo,
-                    'rawMethod' => $match[0]
-                ];
+        preg_match_all(self::BINDING_PATTERN, $content, $matches, PREG_SET_ORDER | PREG_OFFSET_CAPTURE | PREG_UNMATCHED_AS_NULL);
+
+        foreach ($matches as $match) {
+            [$text, $offset] = $match[0];
+
+            if ($match[1][0] === null) {
+                $docComment = $text;
+                $docEnd = $offset + strlen($text);
+
+                if (preg_match('/^[\s*]*struct\s+([a-zA-Z_][a-zA-Z0-9_]*)/m', substr($text, 3, -2), $struct)) {
+                    $structures[$struct[1]] = $struct[1];
+                }
+                continue;
+            }
+
+            // Only a doc comment directly above the method belongs to it
+            if ($docComment !== null && trim(substr($content, $docEnd, $offset - $docEnd)) !== '') {
+                $docComment = null;
+            }
+
+            $functionName = $match[1][0];
+            $docBody = $docComment !== null ? substr($docComment, 3, -2) : '';
+
+            $functions[$functionName] = [
+                'name' => $functionName,
+                'returnType' => $match[3][0] !== null ? trim($match[3][0]) : 'void',
+                'parameters' => $this->parseParameters($match[2][0]),
+                'docComment' => $this->parseDocComment($docBody),
+                'documentation' => $this->parseDocumentationLines($docBody),
+                'rawMethod' => ($docComment !== null ? $docComment . "\n" : '') . $text,
+            ];
+
+            $docComment = null;
+        }
+
+        return ['functions' => $functions, 'structures' => array_values($structures)];
+    }
+
+    /**
+     * Split a doc comment body into its non-empty lines
+     *
+     * @param string $docBody Doc comment without the comment delimiters
+     * @return array<string> Documentation lines
+     */
+    private function parseDocumentationLines(string $docBody): array
+    {
+        $documentation = [];
+
+        foreach (explode("\n", $docBody) as $line) {
+            $line = trim($line, " \t\r*");
+            if ($line !== '') {
+                $documentation[] = $line;
             }
         }
 
-        return $functions;
+        return $documentation;
     }
 
     /**
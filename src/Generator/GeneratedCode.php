@@ -16,12 +16,14 @@ class GeneratedCode
      * @param array<string> $interfaces Generated interfaces
      * @param array<string> $traits Generated traits
      * @param Documentation $documentation Generated documentation
+     * @param array<string, string> $files Generated support files (filename => content)
      */
     public function __construct(
         public readonly array $classes,
         public readonly array $interfaces,
         public readonly array $traits,
-        public readonly Documentation $documentation
+        public readonly Documentation $documentation,
+        public readonly array $files = []
     ) {
     }
 }
\ No newline at end of file
@@ -0,0 +1,164 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Yangweijie\CWrapper\Analyzer\SourceFileRepository;
+use Yangweijie\CWrapper\Config\ProjectConfig;
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Records what an output directory was generated from, for incremental runs
+ *
+ * The manifest stores a fingerprint made of the content hash of every input
+ * header and its resolved include closure, the hash of the project
+ * configuration and the generator version, plus the list of files written.
+ * When a later run computes the same fingerprint and all files still exist,
+ * ffigen and the whole generation can be skipped.
+ */
+class GenerationManifest
+{
+    public const FILENAME = '.ffi-manifest.json';
+
+    /**
+     * Manifest layout version, bump when the fingerprint changes meaning
+     */
+    private const FORMAT = 1;
+
+    private static ?string $generatorVersion = null;
+
+    private OutputWriter $writer;
+    private SourceFileRepository $sources;
+
+    /**
+     * @param SourceFileRepository|null $sources Header contents shared with the other stages
+     */
+    public function __construct(?OutputWriter $writer = null, ?SourceFileRepository $sources = null)
+    {
+        $this->writer = $writer ?? new OutputWriter();
+        $this->sources = $sources ?? new SourceFileRepository();
+    }
+
+    /**
+     * Compute the fingerprint of a generation run
+     *
+     * @param ProjectConfig $config Project configuration
+     * @param array<string> $headerClosure Input headers and every header they include
+     * @return array{format: int, generator: string, config: string, inputs: array<string, string>} Fingerprint
+     */
+    public function createFingerprint(ProjectConfig $config, array $headerClosure): array
+    {
+        $paths = array_map(fn($path) => realpath($path) ?: $path, array_merge($config->getHeaderFiles(), $headerClosure));
+        $paths = array_unique($paths);
+        sort($paths);
+
+        $inputs = [];
+        foreach ($paths as $path) {
+            $inputs[$path] = is_file($path) ? $this->sources->get($path)->getHash() : '';
+        }
+
+        return [
+            'format' => self::FORMAT,
+            'generator' => self::getGeneratorVersion(),
+            'config' => hash('sha256', json_encode($config->toArray(), JSON_THROW_ON_ERROR)),
+            'inputs' => $inputs,
+        ];
+    }
+
+    /**
+     * Check whether an output directory was generated from the same fingerprint
+     *
+     * @param string $outputPath Output directory
+     * @param array<string, mixed> $fingerprint Fingerprint of the current run
+     * @return bool True if nothing relevant changed and every recorded output exists
+     */
+    public function isUpToDate(string $outputPath, array $fingerprint): bool
+    {
+        $manifest = $this->read($outputPath);
+
+        if ($manifest === null) {
+            return false;
+        }
+
+        foreach ($fingerprint as $key => $value) {
+            if (($manifest[$key] ?? null) !== $value) {
+                return false;
+            }
+        }
+
+        foreach ($manifest['outputs'] ?? [] as $filename) {
+            if (!is_file($outputPath . '/' . $filename)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Read the manifest of an output directory
+     *
+     * @param string $outputPath Output directory
+     * @return array<string, mixed>|null Manifest data, null if missing or unreadable
+     */
+    public function read(string $outputPath): ?array
+    {
+        $file = $outputPath . '/' . self::FILENAME;
+
+        if (!is_file($file)) {
+            return null;
+        }
+
+        $manifest = json_decode((string) file_get_contents($file), true);
+
+        return is_array($manifest) ? $manifest : null;
+    }
+
+    /**
+     * Write the manifest of a completed run
+     *
+     * @param string $outputPath Output directory
+     * @param array<string, mixed> $fingerprint Fingerprint of the run
+     * @param array<string> $outputs Files written, relative to the output directory
+     * @throws GenerationException If the manifest cannot be written
+     */
+    public function write(string $outputPath, array $fingerprint, array $outputs): void
+    {
+        $outputs = array_values(array_unique($outputs));
+        sort($outputs);
+
+        $json = json_encode($fingerprint + ['outputs' => $outputs], JSON_PRETTY_PRINT | JSON_UNESCAPED_SLASHES | JSON_THROW_ON_ERROR);
+
+        $this->writer->write($outputPath . '/' . self::FILENAME, $json . "\n");
+    }
+
+    /**
+     * Get the version of the generator code
+     *
+     * Hashes the sources of this package, so any change to the generator
+     * invalidates previous outputs, including during development.
+     *
+     * @return string Generator version hash
+     */
+    public static function getGeneratorVersion(): string
+    {
+        if (self::$generatorVersion !== null) {
+            return self::$generatorVersion;
+        }
+
+        $sourceDir = dirname(__DIR__);
+        $hashes = [];
+
+        $files = new \RecursiveIteratorIterator(new \RecursiveDirectoryIterator($sourceDir, \FilesystemIterator::SKIP_DOTS));
+        foreach ($files as $file) {
+            if ($file->isFile()) {
+                $hashes[substr($file->getPathname(), strlen($sourceDir))] = hash_file('sha256', $file->getPathname());
+            }
+        }
+
+        ksort($hashes);
+
+        return self::$generatorVersion = hash('sha256', json_encode($hashes, JSON_THROW_ON_ERROR));
+    }
+}
\ No newline at end of file
@@ -4,6 +4,8 @@ declare(strict_types=1);
 
 namespace Yangweijie\CWrapper\Generator;
 
+use Yangweijie\CWrapper\Config\GenerationConfig;
+
 /**
  * Improved method generator that uses klitsche/ffigen type information
  * but generates simplified method names for object-oriented classes
@@ -11,10 +13,17 @@ namespace Yangweijie\CWrapper\Generator;
 class ImprovedMethodGenerator
 {
     private FFIGenOutputParser $parser;
-
-    public function __construct(?FFIGenOutputParser $parser = null)
-    {
+    private MethodEmitter $emitter;
+    private TypeMapper $typeMapper;
+
+    public function __construct(
+        ?FFIGenOutputParser $parser = null,
+        ?MethodEmitter $emitter = null,
+        ?TypeMapper $typeMapper = null
+    ) {
         $this->parser = $parser ?? new FFIGenOutputParser();
+        $this->typeMapper = $typeMapper ?? new TypeMapper();
+        $this->emitter = $emitter ?? new MethodEmitter($this->typeMapper);
     }
 
     /**
@@ -24,54 +33,71 @@ class ImprovedMethodGenerator
      * @param array $functionInfo Function info from klitsche/ffigen
      * @param string $className Target class name for method name simplification
      * @param string $generationType Generation type ('object' or 'functional')
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
      * @return string Generated method code
      */
     public function generateImprovedMethod(
         string $functionName,
         array $functionInfo,
         string $className,
-        string $generationType = 'object'
+        string $generationType = 'object',
+        bool $directDispatch = false,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $outParams = false,
+        bool $instrument = false
     ): string {
-        $methodName = $this->generateMethodName($functionName, $className, $generationType);
-        $parameters = $this->generateParameterSignature($functionInfo['parameters']);
-        $returnType = $this->normalizeReturnType($functionInfo['returnType']);
-        
-        $code = "    /**\n";
-        $code .= "     * Wrapper for {$functionName}\n";
-        
-        // Generate parameter documentation
-        foreach ($functionInfo['parameters'] as $param) {
-            $paramType = $this->formatTypeForDoc($param['type'], $param['nullable']);
-            $code .= "     * @param {$paramType} \${$param['name']}\n";
-        }
-        
-        if ($returnType !== 'void') {
-            $returnTypeDoc = $this->formatTypeForDoc($returnType, str_contains($returnType, '?'));
-            $code .= "     * @return {$returnTypeDoc}\n";
-        }
-        
-        $code .= "     */\n";
-        $code .= "    public static function {$methodName}({$parameters})";
-        
-        if ($returnType !== 'void') {
-            $code .= ": {$returnType}";
-        }
-        
-        $code .= "\n    {\n";
-        
-        // Generate FFI call
-        $paramNames = array_map(fn($p) => '$' . $p['name'], $functionInfo['parameters']);
-        $paramList = implode(', ', $paramNames);
-        
-        if ($returnType !== 'void') {
-            $code .= "        return static::getFFI()->{$functionName}({$paramList});\n";
-        } else {
-            $code .= "        static::getFFI()->{$functionName}({$paramList});\n";
-        }
-        
-        $code .= "    }\n";
+        return $this->emitter->emit(
+            $this->buildDefinition($functionName, $functionInfo, $className, $generationType),
+            $profile,
+            $directDispatch,
+            $outParams,
+            $instrument
+        );
+    }
+
+    /**
+     * Describe the wrapper method of a klitsche/ffigen function
+     *
+     * Parameters may carry a 'cType' entry with the C declaration type, it
+     * enables the debug profile checks for that parameter.
+     *
+     * @param string $functionName Original function name
+     * @param array $functionInfo Function info from klitsche/ffigen
+     * @param string $className Target class name for method name simplification
+     * @param string $generationType Generation type ('object' or 'functional')
+     * @return MethodDefinition Method definition
+     */
+    public function buildDefinition(
+        string $functionName,
+        array $functionInfo,
+        string $className,
+        string $generationType = 'object'
+    ): MethodDefinition {
+        $parameters = [];
 
-        return $code;
+        foreach ($functionInfo['parameters'] as $param) {
+            $callbackType = isset($param['cType']) ? $this->typeMapper->getCallbackType($param['cType']) : null;
+
+            $parameters[] = [
+                'name' => $param['name'],
+                'phpType' => $callbackType !== null
+                    ? MethodEmitter::CALLBACK_PHP_TYPE
+                    : $this->normalizeParameterType($param['type'], $param['nullable']),
+                'cType' => $param['cType'] ?? null,
+                'out' => isset($param['cType']) && $this->typeMapper->getOutPointerType($param['cType']) !== null,
+                'callback' => $callbackType,
+            ];
+        }
+
+        return new MethodDefinition(
+            $this->generateMethodName($functionName, $className, $generationType),
+            $functionName,
+            $parameters,
+            $this->normalizeReturnType($functionInfo['returnType'])
+        );
     }
 
     /**
@@ -121,31 +147,6 @@ class ImprovedMethodGenerator
         return lcfirst($simplifiedName);
     }
 
-    /**
-     * Generate parameter signature with correct types
-     *
-     * @param array $parameters Parameter information
-     * @return string Parameter signature
-     */
-    private function generateParameterSignature(array $parameters): string
-    {
-        $paramStrings = [];
-
-        foreach ($parameters as $param) {
-            $type = $this->normalizeParameterType($param['type'], $param['nullable']);
-            $paramString = '';
-
-            if ($type !== 'mixed') {
-                $paramString .= $type . ' ';
-            }
-
-            $paramString .= '$' . $param['name'];
-            $paramStrings[] = $paramString;
-        }
-
-        return implode(', ', $paramStrings);
-    }
-
     /**
      * Normalize parameter type for method signature
      *
@@ -190,24 +191,4 @@ class ImprovedMethodGenerator
 
         return $this->normalizeParameterType($returnType, str_starts_with($returnType, '?'));
     }
-
-    /**
-     * Format type for documentation
-     *
-     * @param string $type Type name
-     * @param bool $nullable Whether nullable
-     * @return string Formatted type for documentation
-     */
-    private function formatTypeForDoc(string $type, bool $nullable): string
-    {
-        if ($nullable && !str_starts_with($type, '?')) {
-            return $type . '|null';
-        }
-
-        if (str_starts_with($type, '?')) {
-            return substr($type, 1) . '|null';
-        }
-
-        return $type;
-    }
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+/**
+ * Intermediate representation of a generated wrapper method
+ *
+ * Both method generators describe a wrapper with this structure, MethodEmitter
+ * turns it into code for the selected profile.
+ */
+class MethodDefinition
+{
+    /**
+     * @param string $name PHP method name
+     * @param string $cFunction Wrapped C function name
+     * @param array<array{name: string, phpType: string, cType: string|null, out?: bool, callback?: string|null}> $parameters
+     *        Parameters, 'mixed' for untyped, 'out' marks scalar out-pointers, 'callback' holds the function
+     *        pointer type of callback parameters
+     * @param string $returnType PHP return type
+     * @param array<string> $documentation Additional documentation lines
+     */
+    public function __construct(
+        public readonly string $name,
+        public readonly string $cFunction,
+        public readonly array $parameters,
+        public readonly string $returnType,
+        public readonly array $documentation = []
+    ) {
+    }
+}
\ No newline at end of file
@@ -0,0 +1,321 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Yangweijie\CWrapper\Config\GenerationConfig;
+
+/**
+ * Emits wrapper method code from a MethodDefinition
+ *
+ * The debug profile validates every argument against its C type before the
+ * call, the release profile relies on the typed signature and emits the FFI
+ * call only.
+ */
+class MethodEmitter
+{
+    /**
+     * Call target for direct dispatch: the class-level FFI handle, resolved once
+     */
+    public const DIRECT_DISPATCH_TARGET = '(self::$ffi ??= static::getFFI())';
+
+    /**
+     * PHP type of function pointer parameters: closures go through CallbackRegistry,
+     * existing function pointers and null are passed as is
+     */
+    public const CALLBACK_PHP_TYPE = '\\Closure|\\FFI\\CData|null';
+
+    private TypeMapper $typeMapper;
+
+    public function __construct(?TypeMapper $typeMapper = null)
+    {
+        $this->typeMapper = $typeMapper ?? new TypeMapper();
+    }
+
+    /**
+     * Emit the code of a wrapper method
+     *
+     * With out-parameters enabled, scalar out-pointers are dropped from the
+     * signature. The method passes the address of a cell allocated once per
+     * method and returns [result, out1, out2, ...] (the outputs only for void
+     * functions).
+     *
+     * With instrumentation, the body reports its wall time and the part spent
+     * before the FFI call to Bootstrap::recordCall(). Without it the emitted
+     * code contains no profiling at all.
+     *
+     * @param MethodDefinition $method Method to emit
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
+     * @return string Generated method code
+     */
+    public function emit(
+        MethodDefinition $method,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $directDispatch = false,
+        bool $outParams = false,
+        bool $instrument = false
+    ): string {
+        $outputs = $outParams ? array_filter($method->parameters, fn($param) => !empty($param['out'])) : [];
+        $inputs = array_filter($method->parameters, fn($param) => !in_array($param, $outputs, true));
+        $returnType = empty($outputs) ? $method->returnType : 'array';
+
+        $code = "    /**\n";
+        $code .= "     * Wrapper for {$method->cFunction}\n";
+
+        foreach ($inputs as $param) {
+            $code .= "     * @param {$this->formatTypeForDoc($param['phpType'])} \${$param['name']}\n";
+        }
+
+        if (!empty($outputs)) {
+            $code .= "     * @return {$this->formatTupleForDoc($method, $outputs)}\n";
+        } elseif ($returnType !== 'void') {
+            $code .= "     * @return {$this->formatTypeForDoc($returnType)}\n";
+        }
+
+        foreach ($method->documentation as $doc) {
+            $code .= "     * {$doc}\n";
+        }
+
+        $code .= "     */\n";
+        $code .= "    public static function {$method->name}({$this->generateSignature($inputs)})";
+
+        if ($returnType !== 'void') {
+            $code .= ": {$returnType}";
+        }
+
+        $code .= "\n    {\n";
+
+        if ($instrument) {
+            $code .= $this->generateInstrumentedBody($method, $inputs, $outputs, $profile, $directDispatch);
+            $code .= "    }\n";
+
+            return $code;
+        }
+
+        if ($profile === GenerationConfig::PROFILE_DEBUG) {
+            $code .= $this->generateValidation($inputs);
+        }
+
+        if (!empty($outputs)) {
+            $code .= $this->generateOutCallBody($method, $outputs, $directDispatch);
+        } elseif ($returnType !== 'void') {
+            $code .= "        return {$this->generateCall($method, $directDispatch, [])};\n";
+        } else {
+            $code .= "        {$this->generateCall($method, $directDispatch, [])};\n";
+        }
+
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate the parameter list of the method signature
+     *
+     * @param array<array{name: string, phpType: string, cType: string|null}> $parameters Parameters
+     * @return string Parameter list
+     */
+    private function generateSignature(array $parameters): string
+    {
+        $paramStrings = [];
+
+        foreach ($parameters as $param) {
+            $paramStrings[] = $param['phpType'] !== 'mixed'
+                ? "{$param['phpType']} \${$param['name']}"
+                : "\${$param['name']}";
+        }
+
+        return implode(', ', $paramStrings);
+    }
+
+    /**
+     * Generate type and range checks for parameters with a known C type
+     *
+     * @param array<array{name: string, phpType: string, cType: string|null}> $parameters Parameters
+     * @return string Validation code
+     */
+    private function generateValidation(array $parameters): string
+    {
+        $validation = '';
+
+        foreach ($parameters as $param) {
+            if ($param['cType'] === null) {
+                continue;
+            }
+
+            $nullable = str_starts_with($param['phpType'], '?') || str_contains($param['phpType'], 'null');
+            $validation .= $this->typeMapper->generateValidation($param['name'], $param['cType'], $nullable);
+            $validation .= $this->typeMapper->generateRangeValidation($param['name'], $param['cType'], $nullable);
+        }
+
+        return $validation;
+    }
+
+    /**
+     * Generate a method body reporting its timings to the Bootstrap profiler
+     *
+     * @param MethodDefinition $method Method definition
+     * @param array<array{name: string, phpType: string, cType: string|null}> $inputs Parameters of the signature
+     * @param array<array{name: string, phpType: string, cType: string|null, out?: bool}> $outputs Out-parameters
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @return string Method body code
+     */
+    private function generateInstrumentedBody(
+        MethodDefinition $method,
+        array $inputs,
+        array $outputs,
+        string $profile,
+        bool $directDispatch
+    ): string {
+        $code = "        \$__start = \\hrtime(true);\n";
+
+        if ($profile === GenerationConfig::PROFILE_DEBUG) {
+            $code .= $this->generateValidation($inputs);
+        }
+
+        if (!empty($outputs)) {
+            $target = $this->getCallTarget($directDispatch);
+            $code .= "        static " . implode(', ', array_map(fn($param) => '$' . $param['name'], $outputs)) . ";\n";
+
+            foreach ($outputs as $param) {
+                $cType = $this->typeMapper->getOutPointerType($param['cType']);
+                $code .= "        \${$param['name']} ??= {$target}->new('{$cType}');\n";
+            }
+        }
+
+        $call = $this->generateCall($method, $directDispatch, $outputs);
+        $code .= "        \$__call = \\hrtime(true);\n";
+        $code .= $method->returnType !== 'void' ? "        \$result = {$call};\n" : "        {$call};\n";
+        $code .= "        Bootstrap::recordCall('{$method->cFunction}', \\hrtime(true) - \$__start, \$__call - \$__start);\n";
+
+        if (!empty($outputs)) {
+            $values = array_map(fn($param) => "\${$param['name']}->cdata", $outputs);
+
+            if ($method->returnType !== 'void') {
+                array_unshift($values, '$result');
+            }
+
+            $code .= "\n        return [" . implode(', ', $values) . "];\n";
+        } elseif ($method->returnType !== 'void') {
+            $code .= "\n        return \$result;\n";
+        }
+
+        return $code;
+    }
+
+    /**
+     * Generate a call through reused out-parameter cells returning a tuple
+     *
+     * @param MethodDefinition $method Method definition
+     * @param array<array{name: string, phpType: string, cType: string|null, out?: bool}> $outputs Out-parameters
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @return string Method body code
+     */
+    private function generateOutCallBody(MethodDefinition $method, array $outputs, bool $directDispatch): string
+    {
+        $target = $this->getCallTarget($directDispatch);
+        $cells = array_map(fn($param) => '$' . $param['name'], $outputs);
+        $values = array_map(fn($cell) => "{$cell}->cdata", $cells);
+
+        $code = "        static " . implode(', ', $cells) . ";\n";
+
+        foreach ($outputs as $param) {
+            $cType = $this->typeMapper->getOutPointerType($param['cType']);
+            $code .= "        \${$param['name']} ??= {$target}->new('{$cType}');\n";
+        }
+
+        $code .= "\n";
+
+        if ($method->returnType !== 'void') {
+            $code .= "        \$result = {$this->generateCall($method, $directDispatch, $outputs)};\n\n";
+            array_unshift($values, '$result');
+        } else {
+            $code .= "        {$this->generateCall($method, $directDispatch, $outputs)};\n\n";
+        }
+
+        $code .= "        return [" . implode(', ', $values) . "];\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate the FFI call expression
+     *
+     * @param MethodDefinition $method Method definition
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param array<array{name: string, phpType: string, cType: string|null, out?: bool}> $outputs Out-parameters passed by cell address
+     * @return string FFI call code
+     */
+    private function generateCall(MethodDefinition $method, bool $directDispatch, array $outputs): string
+    {
+        $arguments = [];
+
+        foreach ($method->parameters as $param) {
+            if (in_array($param, $outputs, true)) {
+                $arguments[] = "\\FFI::addr(\${$param['name']})";
+            } elseif (!empty($param['callback'])) {
+                $arguments[] = "\${$param['name']} instanceof \\Closure"
+                    . " ? CallbackRegistry::get(\${$param['name']}, '{$param['callback']}')"
+                    . " : \${$param['name']}";
+            } else {
+                $arguments[] = '$' . $param['name'];
+            }
+        }
+
+        return "{$this->getCallTarget($directDispatch)}->{$method->cFunction}(" . implode(', ', $arguments) . ")";
+    }
+
+    /**
+     * Get the expression yielding the FFI instance
+     *
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @return string FFI instance expression
+     */
+    private function getCallTarget(bool $directDispatch): string
+    {
+        return $directDispatch ? self::DIRECT_DISPATCH_TARGET : 'static::getFFI()';
+    }
+
+    /**
+     * Format the tuple returned by a method with out-parameters
+     *
+     * @param MethodDefinition $method Method definition
+     * @param array<array{name: string, phpType: string, cType: string|null, out?: bool}> $outputs Out-parameters
+     * @return string Array shape for documentation
+     */
+    private function formatTupleForDoc(MethodDefinition $method, array $outputs): string
+    {
+        $types = [];
+
+        if ($method->returnType !== 'void') {
+            $types[] = $this->formatTypeForDoc($method->returnType);
+        }
+
+        foreach ($outputs as $param) {
+            $types[] = $this->typeMapper->mapCTypeToPhp($this->typeMapper->getOutPointerType($param['cType']));
+        }
+
+        $shape = [];
+        foreach ($types as $index => $type) {
+            $shape[] = "{$index}: {$type}";
+        }
+
+        return 'array{' . implode(', ', $shape) . '}';
+    }
+
+    /**
+     * Format a PHP type for documentation
+     *
+     * @param string $type PHP type
+     * @return string Type with nullability spelled as a union
+     */
+    private function formatTypeForDoc(string $type): string
+    {
+        return str_starts_with($type, '?') ? substr($type, 1) . '|null' : $type;
+    }
+}
\ No newline at end of file
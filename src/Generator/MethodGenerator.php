@@ -5,6 +5,7 @@ declare(strict_types=1);
 namespace Yangweijie\CWrapper\Generator;
 
 use Yangweijie\CWrapper\Analyzer\FunctionSignature;
+use Yangweijie\CWrapper\Config\GenerationConfig;
 
 /**
  * Generates PHP wrapper methods with FFI calls
@@ -12,10 +13,12 @@ use Yangweijie\CWrapper\Analyzer\FunctionSignature;
 class MethodGenerator
 {
     private TypeMapper $typeMapper;
+    private MethodEmitter $emitter;
 
-    public function __construct(?TypeMapper $typeMapper = null)
+    public function __construct(?TypeMapper $typeMapper = null, ?MethodEmitter $emitter = null)
     {
         $this->typeMapper = $typeMapper ?? new TypeMapper();
+        $this->emitter = $emitter ?? new MethodEmitter($this->typeMapper);
     }
 
     /**
@@ -24,61 +27,120 @@ class MethodGenerator
      * @param FunctionSignature $function Function signature to wrap
      * @param string $generationType Generation type: 'object' or 'functional'
      * @param string $className Class name for context (optional)
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
      * @return string Generated method code
      */
-    public function generateMethod(FunctionSignature $function, string $generationType = 'object', string $className = ''): string
-    {
-        $methodName = $this->convertFunctionName($function->name, $generationType, $className);
-        $parameters = $this->generateParameters($function->parameters);
-        $parameterList = $this->generateParameterList($function->parameters);
-        $returnType = $this->mapReturnType($function->returnType);
-        $ffiCall = $this->generateFFICall($function);
+    public function generateMethod(
+        FunctionSignature $function,
+        string $generationType = 'object',
+        string $className = '',
+        bool $directDispatch = false,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $outParams = false,
+        bool $instrument = false
+    ): string {
+        return $this->emitter->emit(
+            $this->buildDefinition($function, $generationType, $className),
+            $profile,
+            $directDispatch,
+            $outParams,
+            $instrument
+        );
+    }
+
+    /**
+     * Describe the wrapper method of a C function signature
+     *
+     * @param FunctionSignature $function Function signature to wrap
+     * @param string $generationType Generation type: 'object' or 'functional'
+     * @param string $className Class name for context (optional)
+     * @return MethodDefinition Method definition
+     */
+    public function buildDefinition(
+        FunctionSignature $function,
+        string $generationType = 'object',
+        string $className = ''
+    ): MethodDefinition {
+        $parameters = [];
 
-        $code = "    /**\n";
-        $code .= "     * Wrapper for {$function->name}\n";
-        
-        // Add parameter documentation with improved type mapping
         foreach ($function->parameters as $param) {
-            $phpType = $this->mapParameterType($param['type']);
-            $code .= "     * @param {$phpType} \${$param['name']}\n";
-        }
-        
-        if ($returnType !== 'void') {
-            $code .= "     * @return {$returnType}\n";
-        }
-        
-        // Add any existing documentation
-        foreach ($function->documentation as $doc) {
-            $code .= "     * {$doc}\n";
+            $callbackType = $this->typeMapper->getCallbackType($param['type']);
+
+            $parameters[] = [
+                'name' => $param['name'],
+                'phpType' => $callbackType !== null ? MethodEmitter::CALLBACK_PHP_TYPE : $this->mapParameterType($param['type']),
+                'cType' => $param['type'],
+                'out' => $this->typeMapper->getOutPointerType($param['type']) !== null,
+                'callback' => $callbackType,
+            ];
         }
-        
+
+        return new MethodDefinition(
+            $this->convertFunctionName($function->name, $generationType, $className),
+            $function->name,
+            $parameters,
+            $this->mapReturnType($function->returnType),
+            $function->documentation
+        );
+    }
+
+    /**
+     * Generate a batch wrapper calling the shim loop of a scalar function
+     *
+     * @param FunctionSignature $function Batchable function signature
+     * @param string $inputType C element type of the input array
+     * @param string $outputType C element type of the result array
+     * @param string $generationType Generation type: 'object' or 'functional'
+     * @param string $className Class name for context (optional)
+     * @return string Generated method code
+     */
+    public function generateBatchMethod(
+        FunctionSignature $function,
+        string $inputType,
+        string $outputType,
+        string $generationType = 'object',
+        string $className = ''
+    ): string {
+        $methodName = $this->convertFunctionName($function->name, $generationType, $className) . 'Batch';
+        $batchFunction = $function->name . BatchShimGenerator::SUFFIX;
+        $arity = count($function->parameters);
+        $elementType = $this->typeMapper->mapCTypeToPhp($inputType);
+
+        $code = "    /**\n";
+        $code .= "     * Batch wrapper for {$function->name}, one FFI call for all rows\n";
+        $code .= "     *\n";
+        $code .= "     * @param array<{$elementType}>|\\FFI\\CData \$in {$arity} {$inputType} argument(s) per row, row after row\n";
+        $code .= "     * @return \\FFI\\CData {$outputType} array with one result per row\n";
         $code .= "     */\n";
-        
-        // Generate method signature based on generation type
-        if ($generationType === 'functional') {
-            // For functional mode, use the original C function name and make it static
-            $code .= "    public static function {$function->name}({$parameters})";
-        } else {
-            // For object mode, use converted method name and make it static (for Bootstrap pattern)
-            $code .= "    public static function {$methodName}({$parameters})";
-        }
-        
-        if ($returnType !== 'void') {
-            $code .= ": {$returnType}";
-        }
-        
-        $code .= "\n    {\n";
-        
-        // Add parameter validation
-        $code .= $this->generateParameterValidation($function->parameters);
-        
-        // Add FFI call
-        if ($returnType !== 'void') {
-            $code .= "        return {$ffiCall};\n";
+        $code .= "    public static function {$methodName}(array|\\FFI\\CData \$in): \\FFI\\CData\n";
+        $code .= "    {\n";
+        $code .= "        \$ffi = Bootstrap::getBatchFFI();\n";
+        $code .= "        \$count = count(\$in);\n\n";
+
+        if ($arity === 1) {
+            $code .= "        if (\$count === 0) {\n";
+            $code .= "            throw new \\InvalidArgumentException('Batch input for {$function->name} must not be empty');\n";
         } else {
-            $code .= "        {$ffiCall};\n";
+            $code .= "        if (\$count === 0 || \$count % {$arity} !== 0) {\n";
+            $code .= "            throw new \\InvalidArgumentException('Batch input for {$function->name} must hold a positive multiple of {$arity} values');\n";
         }
-        
+        $code .= "        }\n\n";
+
+        $code .= "        if (is_array(\$in)) {\n";
+        $code .= "            \$values = array_values(\$in);\n";
+        $code .= "            \$in = \$ffi->new('{$inputType}[' . \$count . ']');\n";
+        $code .= "            foreach (\$values as \$index => \$value) {\n";
+        $code .= "                \$in[\$index] = \$value;\n";
+        $code .= "            }\n";
+        $code .= "        }\n\n";
+
+        $rows = $arity === 1 ? '$count' : "intdiv(\$count, {$arity})";
+        $code .= "        \$out = \$ffi->new('{$outputType}[' . {$rows} . ']');\n";
+        $code .= "        \$ffi->{$batchFunction}(\$in, \$out, {$rows});\n\n";
+        $code .= "        return \$out;\n";
         $code .= "    }\n";
 
         return $code;
@@ -222,75 +284,4 @@ class MethodGenerator
         // Use TypeMapper for basic types
         return $this->typeMapper->mapCTypeToPhp($cType, false);
     }
-
-    /**
-     * Generate parameter list for method signature
-     *
-     * @param array<array{name: string, type: string}> $parameters Function parameters
-     * @return string Parameter list string
-     */
-    private function generateParameters(array $parameters): string
-    {
-        $paramStrings = [];
-        
-        foreach ($parameters as $param) {
-            $phpType = $this->mapParameterType($param['type']);
-            $paramString = '';
-            
-            if ($phpType !== 'mixed') {
-                $paramString .= $phpType . ' ';
-            }
-            
-            $paramString .= '$' . $param['name'];
-            $paramStrings[] = $paramString;
-        }
-        
-        return implode(', ', $paramStrings);
-    }
-
-    /**
-     * Generate parameter list for FFI call
-     *
-     * @param array<array{name: string, type: string}> $parameters Function parameters
-     * @return string Parameter list for FFI call
-     */
-    private function generateParameterList(array $parameters): string
-    {
-        $paramNames = [];
-        
-        foreach ($parameters as $param) {
-            $paramNames[] = '$' . $param['name'];
-        }
-        
-        return implode(', ', $paramNames);
-    }
-
-    /**
-     * Generate FFI function call
-     *
-     * @param FunctionSignature $function Function signature
-     * @return string FFI call code
-     */
-    private function generateFFICall(FunctionSignature $function): string
-    {
-        $paramList = $this->generateParameterList($function->parameters);
-        return "static::getFFI()->{$function->name}({$paramList})";
-    }
-
-    /**
-     * Generate parameter validation code
-     *
-     * @param array<array{name: string, type: string}> $parameters Function parameters
-     * @return string Validation code
-     */
-    private function generateParameterValidation(array $parameters): string
-    {
-        $validation = '';
-        
-        foreach ($parameters as $param) {
-            $validation .= $this->typeMapper->generateValidation($param['name'], $param['type']);
-        }
-        
-        return $validation;
-    }
 }
\ No newline at end of file
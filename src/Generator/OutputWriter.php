@@ -0,0 +1,84 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Writes generated files only when their content changed
+ *
+ * Unchanged files keep their mtime, so opcache entries and autoloader caches
+ * stay valid across runs. Changed files are written to a temporary file in
+ * the same directory and renamed over the target, so a server reading the
+ * directory never sees a partially written class.
+ */
+class OutputWriter
+{
+    /**
+     * Write a file if its content differs
+     *
+     * @param string $path Target file
+     * @param string $content File content
+     * @return bool True if the file was written, false if it already had this content
+     * @throws GenerationException If the file cannot be written
+     */
+    public function write(string $path, string $content): bool
+    {
+        if (is_file($path)
+            && filesize($path) === strlen($content)
+            && hash_file('xxh128', $path) === hash('xxh128', $content)) {
+            return false;
+        }
+
+        $directory = dirname($path);
+        if (!is_dir($directory) && !mkdir($directory, 0755, true) && !is_dir($directory)) {
+            throw new GenerationException("Failed to create output directory: {$directory}");
+        }
+
+        $temporary = tempnam($directory, '.' . basename($path) . '.');
+        if ($temporary === false) {
+            throw new GenerationException("Failed to create a temporary file in {$directory}");
+        }
+
+        // tempnam() creates the file readable by the owner only
+        chmod($temporary, 0666 & ~umask());
+
+        if (file_put_contents($temporary, $content) === false || !rename($temporary, $path)) {
+            @unlink($temporary);
+            throw new GenerationException("Failed to write generated file: {$path}");
+        }
+
+        return true;
+    }
+
+    /**
+     * Remove files of a previous run that are no longer generated
+     *
+     * Only files recorded as outputs of the previous run are considered, so
+     * files added to the output directory by hand are never removed.
+     *
+     * @param string $outputPath Output directory
+     * @param array<string> $previousOutputs Files of the previous run, relative to the output directory
+     * @param array<string> $currentOutputs Files of this run, relative to the output directory
+     * @return array<string> Removed files
+     */
+    public function prune(string $outputPath, array $previousOutputs, array $currentOutputs): array
+    {
+        $removed = [];
+
+        foreach (array_diff($previousOutputs, $currentOutputs) as $filename) {
+            if (!is_string($filename) || $filename === '' || str_contains($filename, '..')) {
+                continue;
+            }
+
+            $path = $outputPath . '/' . $filename;
+            if (is_file($path) && unlink($path)) {
+                $removed[] = $filename;
+            }
+        }
+
+        return $removed;
+    }
+}
\ No newline at end of file
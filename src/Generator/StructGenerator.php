@@ -62,6 +62,252 @@ class StructGenerator
         );
     }
 
+    /**
+     * Generate a PHP class wrapping the C memory of a structure
+     *
+     * Accessors read and write the wrapped FFI\\CData in place, so values cross
+     * into C without being marshalled.
+     *
+     * @param StructureDefinition $structure Structure to convert
+     * @param string $namespace Namespace for the generated class
+     * @param string $bootstrapClass Fully qualified Bootstrap class providing the FFI instance
+     * @return WrapperClass Generated wrapper class for the struct
+     */
+    public function generateCDataStructClass(
+        StructureDefinition $structure,
+        string $namespace,
+        string $bootstrapClass
+    ): WrapperClass {
+        $className = $this->convertStructName($structure->name);
+        $cType = $this->getCTypeName($structure);
+
+        $properties = [
+            "    public const C_TYPE = " . var_export($cType, true) . ";\n",
+            "    private \\FFI\\CData \$cdata;\n",
+        ];
+
+        $methods = [
+            $this->generateCDataConstructor($cType),
+            $this->generateCDataFactories($cType, $bootstrapClass),
+        ];
+
+        foreach ($structure->fields as $field) {
+            $methods[] = $this->generateCDataGetter($field);
+
+            if ($this->isCDataWritable($field)) {
+                $methods[] = $this->generateCDataSetter($field);
+            }
+        }
+
+        $methods[] = $this->generateCDataToArrayMethod($structure);
+        $methods[] = $this->generateCDataFromArrayMethod($structure);
+
+        return new WrapperClass(
+            $className,
+            $namespace,
+            $methods,
+            $properties,
+            []
+        );
+    }
+
+    /**
+     * Generate a typed view over a contiguous array of a structure
+     *
+     * The class wraps one T[n] allocation or a T* buffer and converts whole
+     * buffers to and from packed binary strings with FFI::memcpy().
+     *
+     * @param StructureDefinition $structure Element structure
+     * @param string $namespace Namespace for the generated class
+     * @param string $bootstrapClass Fully qualified Bootstrap class providing the FFI instance
+     * @param bool $wrapElements Return elements as CData-backed struct classes instead of raw CData
+     * @return WrapperClass Generated array view class
+     */
+    public function generateStructArrayClass(
+        StructureDefinition $structure,
+        string $namespace,
+        string $bootstrapClass,
+        bool $wrapElements = false
+    ): WrapperClass {
+        $elementClass = $this->convertStructName($structure->name);
+        $elementType = $wrapElements ? $elementClass : '\\FFI\\CData';
+        $cType = $this->getCTypeName($structure);
+
+        $properties = [
+            "    public const ELEMENT_TYPE = " . var_export($cType, true) . ";\n",
+            "    private \\FFI\\CData \$cdata;\n",
+            "    private int \$length;\n",
+            "    private static ?int \$elementSize = null;\n",
+        ];
+
+        $methods = [];
+
+        $code = "    /**\n";
+        $code .= "     * Wrap existing {$cType} elements without copying\n";
+        $code .= "     * @param \\FFI\\CData \$cdata {$cType} array or pointer to the first element\n";
+        $code .= "     * @param int \$length Number of elements\n";
+        $code .= "     */\n";
+        $code .= "    public function __construct(\\FFI\\CData \$cdata, int \$length)\n";
+        $code .= "    {\n";
+        $code .= "        \$this->cdata = \$cdata;\n";
+        $code .= "        \$this->length = \$length;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Allocate a zero-initialized {$cType}[length]\n";
+        $code .= "     * @param int \$length Number of elements\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function create(int \$length): self\n";
+        $code .= "    {\n";
+        $code .= "        if (\$length < 1) {\n";
+        $code .= "            throw new \\InvalidArgumentException('Struct array length must be positive');\n";
+        $code .= "        }\n\n";
+        $code .= "        return new self(\\{$bootstrapClass}::getFFI()->new(self::ELEMENT_TYPE . '[' . \$length . ']'), \$length);\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Wrap a {$cType} buffer returned by C, without copying\n";
+        $code .= "     * @param \\FFI\\CData \$pointer Pointer to the first element\n";
+        $code .= "     * @param int \$length Number of elements\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function fromPointer(\\FFI\\CData \$pointer, int \$length): self\n";
+        $code .= "    {\n";
+        $code .= "        return new self(\$pointer, \$length);\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Allocate an array holding a copy of packed {$cType} elements\n";
+        $code .= "     * @param string \$bytes Native-layout element bytes, e.g. read from a binary file\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function fromPacked(string \$bytes): self\n";
+        $code .= "    {\n";
+        $code .= "        \$size = self::elementSize();\n";
+        $code .= "        if (\$bytes === '' || strlen(\$bytes) % \$size !== 0) {\n";
+        $code .= "            throw new \\InvalidArgumentException('Packed data must hold a positive multiple of ' . \$size . ' bytes');\n";
+        $code .= "        }\n\n";
+        $code .= "        \$array = self::create(intdiv(strlen(\$bytes), \$size));\n";
+        $code .= "        \\FFI::memcpy(\$array->cdata, \$bytes, strlen(\$bytes));\n\n";
+        $code .= "        return \$array;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Copy all elements into a packed binary string\n";
+        $code .= "     * @return string Native-layout element bytes\n";
+        $code .= "     */\n";
+        $code .= "    public function toPacked(): string\n";
+        $code .= "    {\n";
+        $code .= "        return \\FFI::string(\$this->cdata, \$this->length * self::elementSize());\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Get the size of one element in bytes, resolved once\n";
+        $code .= "     * @return int\n";
+        $code .= "     */\n";
+        $code .= "    public static function elementSize(): int\n";
+        $code .= "    {\n";
+        $code .= "        return self::\$elementSize ??= \\FFI::sizeof(\\{$bootstrapClass}::getFFI()->type(self::ELEMENT_TYPE));\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Get the wrapped array or pointer, e.g. to pass the buffer to C\n";
+        $code .= "     * @return \\FFI\\CData\n";
+        $code .= "     */\n";
+        $code .= "    public function getCData(): \\FFI\\CData\n";
+        $code .= "    {\n";
+        $code .= "        return \$this->cdata;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * @return int Number of elements\n";
+        $code .= "     */\n";
+        $code .= "    public function count(): int\n";
+        $code .= "    {\n";
+        $code .= "        return \$this->length;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * @param mixed \$offset Element index\n";
+        $code .= "     * @return bool\n";
+        $code .= "     */\n";
+        $code .= "    public function offsetExists(mixed \$offset): bool\n";
+        $code .= "    {\n";
+        $code .= "        return is_int(\$offset) && \$offset >= 0 && \$offset < \$this->length;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Get an element, reads and writes on it go to the array memory\n";
+        $code .= "     * @param mixed \$offset Element index\n";
+        $code .= "     * @return {$elementType}\n";
+        $code .= "     */\n";
+        $code .= "    public function offsetGet(mixed \$offset): {$elementType}\n";
+        $code .= "    {\n";
+        $code .= "        if (!\$this->offsetExists(\$offset)) {\n";
+        $code .= "            throw new \\OutOfRangeException('Struct array index out of range: ' . var_export(\$offset, true));\n";
+        $code .= "        }\n\n";
+        $code .= $wrapElements
+            ? "        return new {$elementClass}(\$this->cdata[\$offset]);\n"
+            : "        return \$this->cdata[\$offset];\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * Copy a struct into an element\n";
+        $code .= "     * @param mixed \$offset Element index\n";
+        $code .= "     * @param mixed \$value " . ($wrapElements ? "{$elementClass} or " : '') . "{$cType} CData\n";
+        $code .= "     */\n";
+        $code .= "    public function offsetSet(mixed \$offset, mixed \$value): void\n";
+        $code .= "    {\n";
+        $code .= "        if (!\$this->offsetExists(\$offset)) {\n";
+        $code .= "            throw new \\OutOfRangeException('Struct array index out of range: ' . var_export(\$offset, true));\n";
+        $code .= "        }\n\n";
+        $code .= $wrapElements
+            ? "        \$this->cdata[\$offset] = \$value instanceof {$elementClass} ? \$value->getCData() : \$value;\n"
+            : "        \$this->cdata[\$offset] = \$value;\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * @param mixed \$offset Element index\n";
+        $code .= "     */\n";
+        $code .= "    public function offsetUnset(mixed \$offset): void\n";
+        $code .= "    {\n";
+        $code .= "        throw new \\LogicException('Cannot unset elements of a fixed-size struct array');\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        $code = "    /**\n";
+        $code .= "     * @return \\Generator<int, {$elementType}>\n";
+        $code .= "     */\n";
+        $code .= "    public function getIterator(): \\Generator\n";
+        $code .= "    {\n";
+        $code .= "        for (\$i = 0; \$i < \$this->length; \$i++) {\n";
+        $code .= "            yield \$i => \$this->offsetGet(\$i);\n";
+        $code .= "        }\n";
+        $code .= "    }\n";
+        $methods[] = $code;
+
+        return new WrapperClass(
+            $elementClass . 'Array',
+            $namespace,
+            $methods,
+            $properties,
+            [],
+            ['ArrayAccess', 'IteratorAggregate', 'Countable']
+        );
+    }
+
     /**
      * Generate complete struct class code using templates
      *
@@ -259,6 +505,239 @@ class StructGenerator
         return $code;
     }
 
+    /**
+     * Get the C type name used to allocate a structure
+     *
+     * @param StructureDefinition $structure Structure definition
+     * @return string Typedef name, or C type name including the struct/union keyword
+     */
+    private function getCTypeName(StructureDefinition $structure): string
+    {
+        if ($structure->cType !== null) {
+            return $structure->cType;
+        }
+
+        if (preg_match('/^(struct|union)\s+/', $structure->name)) {
+            return $structure->name;
+        }
+
+        return ($structure->isUnion ? 'union ' : 'struct ') . $structure->name;
+    }
+
+    /**
+     * Generate constructor wrapping existing struct memory
+     *
+     * @param string $cType C type name
+     * @return string Constructor code
+     */
+    private function generateCDataConstructor(string $cType): string
+    {
+        $code = "    /**\n";
+        $code .= "     * Wrap existing {$cType} memory without copying\n";
+        $code .= "     * @param \\FFI\\CData \$cdata {$cType} value\n";
+        $code .= "     */\n";
+        $code .= "    public function __construct(\\FFI\\CData \$cdata)\n";
+        $code .= "    {\n";
+        $code .= "        \$this->cdata = \$cdata;\n";
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate allocation, pointer and raw access methods
+     *
+     * @param string $cType C type name
+     * @param string $bootstrapClass Fully qualified Bootstrap class
+     * @return string Methods code
+     */
+    private function generateCDataFactories(string $cType, string $bootstrapClass): string
+    {
+        $code = "    /**\n";
+        $code .= "     * Allocate a zero-initialized {$cType}\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function create(): self\n";
+        $code .= "    {\n";
+        $code .= "        return new self(\\{$bootstrapClass}::getFFI()->new(self::C_TYPE));\n";
+        $code .= "    }\n\n";
+
+        $code .= "    /**\n";
+        $code .= "     * Wrap the struct a pointer refers to, without copying\n";
+        $code .= "     * @param \\FFI\\CData \$pointer {$cType} pointer\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function fromPointer(\\FFI\\CData \$pointer): self\n";
+        $code .= "    {\n";
+        $code .= "        return new self(\$pointer[0]);\n";
+        $code .= "    }\n\n";
+
+        $code .= "    /**\n";
+        $code .= "     * Get the wrapped struct memory\n";
+        $code .= "     * @return \\FFI\\CData\n";
+        $code .= "     */\n";
+        $code .= "    public function getCData(): \\FFI\\CData\n";
+        $code .= "    {\n";
+        $code .= "        return \$this->cdata;\n";
+        $code .= "    }\n\n";
+
+        $code .= "    /**\n";
+        $code .= "     * Get a pointer to the wrapped struct for C functions taking {$cType} *\n";
+        $code .= "     * @return \\FFI\\CData\n";
+        $code .= "     */\n";
+        $code .= "    public function addr(): \\FFI\\CData\n";
+        $code .= "    {\n";
+        $code .= "        return \\FFI::addr(\$this->cdata);\n";
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate in-place getter for a field
+     *
+     * @param array{name: string, type: string} $field Struct field
+     * @return string Getter method code
+     */
+    private function generateCDataGetter(array $field): string
+    {
+        $phpType = $this->getCDataFieldType($field);
+        $methodName = 'get' . ucfirst($field['name']);
+
+        $code = "    /**\n";
+        $code .= "     * Get {$field['name']} field (C type: {$field['type']})\n";
+        $code .= "     * @return {$phpType}\n";
+        $code .= "     */\n";
+        $code .= "    public function {$methodName}(): {$phpType}\n";
+        $code .= "    {\n";
+
+        if ($phpType === '?string') {
+            $code .= "        \$value = \$this->cdata->{$field['name']};\n";
+            $code .= "        return \\FFI::isNull(\$value) ? null : \\FFI::string(\$value);\n";
+        } else {
+            $code .= "        return \$this->cdata->{$field['name']};\n";
+        }
+
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate in-place setter for a field
+     *
+     * @param array{name: string, type: string} $field Struct field
+     * @return string Setter method code
+     */
+    private function generateCDataSetter(array $field): string
+    {
+        $phpType = $this->getCDataFieldType($field);
+        $methodName = 'set' . ucfirst($field['name']);
+        $parameter = $phpType !== 'mixed' ? "{$phpType} \${$field['name']}" : "\${$field['name']}";
+
+        $code = "    /**\n";
+        $code .= "     * Set {$field['name']} field (C type: {$field['type']})\n";
+        $code .= "     * @param {$phpType} \${$field['name']}\n";
+        $code .= "     */\n";
+        $code .= "    public function {$methodName}({$parameter}): void\n";
+        $code .= "    {\n";
+        $code .= "        \$this->cdata->{$field['name']} = \${$field['name']};\n";
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate toArray method reading the struct memory
+     *
+     * @param StructureDefinition $structure Structure definition
+     * @return string toArray method code
+     */
+    private function generateCDataToArrayMethod(StructureDefinition $structure): string
+    {
+        $code = "    /**\n";
+        $code .= "     * Convert struct to array\n";
+        $code .= "     * @return array<string, mixed>\n";
+        $code .= "     */\n";
+        $code .= "    public function toArray(): array\n";
+        $code .= "    {\n";
+        $code .= "        return [\n";
+
+        foreach ($structure->fields as $field) {
+            $code .= "            '{$field['name']}' => \$this->get" . ucfirst($field['name']) . "(),\n";
+        }
+
+        $code .= "        ];\n";
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Generate fromArray method allocating and filling a struct
+     *
+     * @param StructureDefinition $structure Structure definition
+     * @return string fromArray method code
+     */
+    private function generateCDataFromArrayMethod(StructureDefinition $structure): string
+    {
+        $code = "    /**\n";
+        $code .= "     * Create struct from array\n";
+        $code .= "     * @param array<string, mixed> \$data\n";
+        $code .= "     * @return self\n";
+        $code .= "     */\n";
+        $code .= "    public static function fromArray(array \$data): self\n";
+        $code .= "    {\n";
+        $code .= "        \$struct = self::create();\n";
+
+        foreach ($structure->fields as $field) {
+            if ($this->isCDataWritable($field)) {
+                $code .= "        if (array_key_exists('{$field['name']}', \$data)) {\n";
+                $code .= "            \$struct->set" . ucfirst($field['name']) . "(\$data['{$field['name']}']);\n";
+                $code .= "        }\n";
+            }
+        }
+
+        $code .= "        return \$struct;\n";
+        $code .= "    }\n";
+
+        return $code;
+    }
+
+    /**
+     * Get the PHP type a field reads as through FFI
+     *
+     * Strings are returned as copies, arrays, pointers and nested structs as
+     * CData views on the struct memory.
+     *
+     * @param array{name: string, type: string} $field Struct field
+     * @return string PHP type
+     */
+    private function getCDataFieldType(array $field): string
+    {
+        $phpType = $this->typeMapper->mapCTypeToPhp($field['type']);
+
+        return match ($phpType) {
+            'string' => '?string',
+            'array', '\\FFI\\CData' => '\\FFI\\CData',
+            default => $phpType,
+        };
+    }
+
+    /**
+     * Check whether a field can be assigned in place
+     *
+     * C strings would need memory owned by the struct and arrays are written
+     * through the view returned by the getter.
+     *
+     * @param array{name: string, type: string} $field Struct field
+     * @return bool True if a setter is generated
+     */
+    private function isCDataWritable(array $field): bool
+    {
+        return !in_array($this->typeMapper->mapCTypeToPhp($field['type']), ['string', 'array'], true);
+    }
+
     /**
      * Get default value for a PHP type
      *
@@ -7,19 +7,41 @@ namespace Yangweijie\CWrapper\Generator;
 use Twig\Environment;
 use Twig\Loader\FilesystemLoader;
 use Twig\Loader\ArrayLoader;
+use Twig\TemplateWrapper;
 use Yangweijie\CWrapper\Exception\GenerationException;
 
 /**
  * Template engine for code generation using Twig
+ *
+ * Compiled templates are kept in the private cache directory, so a run
+ * only compiles templates whose source changed since the last one; custom
+ * template files are checked for changes on load. Inline templates are
+ * compiled once per engine.
  */
 class TemplateEngine
 {
     private Environment $twig;
     private array $defaultTemplates;
+    private TypeMapper $typeMapper;
 
-    public function __construct(?string $templatePath = null)
-    {
+    /** @var array<string, TemplateWrapper> */
+    private array $inlineTemplates = [];
+
+    /**
+     * @param string|null $templatePath Directory of custom templates overriding the defaults
+     * @param string|false|null $cacheDir Compiled template cache, the twig directory of the per-user cache by default, false to disable
+     * @param bool $debug Enable Twig debug mode
+     * @param TypeMapper|null $typeMapper Type mapper behind the php_type and validation_code functions
+     * @throws GenerationException If the default cache directory cannot be created
+     */
+    public function __construct(
+        ?string $templatePath = null,
+        string|false|null $cacheDir = null,
+        bool $debug = false,
+        ?TypeMapper $typeMapper = null
+    ) {
         $this->defaultTemplates = $this->getDefaultTemplates();
+        $this->typeMapper = $typeMapper ?? new TypeMapper();
         
         if ($templatePath && is_dir($templatePath)) {
             // Use filesystem loader for custom templates with fallback to array loader
@@ -33,8 +55,9 @@ class TemplateEngine
         }
         
         $this->twig = new Environment($loader, [
-            'cache' => false,
-            'debug' => true,
+            'cache' => $cacheDir ?? CacheDirectory::get(null, 'twig'),
+            'auto_reload' => true, // Recompile custom templates edited since they were cached
+            'debug' => $debug,
             'strict_variables' => true,
             'autoescape' => false, // Disable auto-escaping for code generation
         ]);
@@ -62,7 +85,9 @@ class TemplateEngine
             
             // Check if this is an inline template (contains Twig syntax)
             if (str_contains($templateName, '{{') || str_contains($templateName, '{%')) {
-                return $this->twig->createTemplate($templateName)->render($data);
+                $this->inlineTemplates[$templateName] ??= $this->twig->createTemplate($templateName);
+
+                return $this->inlineTemplates[$templateName]->render($data);
             }
             
             return $this->twig->render($templateName, $data);
@@ -71,18 +96,44 @@ class TemplateEngine
         }
     }
 
+    /**
+     * Compile the default templates into the cache
+     *
+     * Run once after installing or upgrading, so the first generation
+     * does not pay for compiling them.
+     *
+     * @return array<string> Names of the compiled templates
+     * @throws GenerationException If a template fails to compile
+     */
+    public function warmup(): array
+    {
+        $names = array_keys($this->defaultTemplates);
+
+        foreach ($names as $name) {
+            try {
+                $this->twig->load($name);
+            } catch (\Throwable $e) {
+                throw new GenerationException("Failed to compile template '{$name}': " . $e->getMessage(), 0, $e);
+            }
+        }
+
+        return $names;
+    }
+
     /**
      * Render wrapper class template
      *
      * @param WrapperClass $wrapperClass Wrapper class data
      * @param string $libraryPath Path to C library
+     * @param string|null $ffiAccessor Custom getFFI() method code, null to delegate to Bootstrap
      * @return string Rendered class code
      */
-    public function renderWrapperClass(WrapperClass $wrapperClass, string $libraryPath): string
+    public function renderWrapperClass(WrapperClass $wrapperClass, string $libraryPath, ?string $ffiAccessor = null): string
     {
         return $this->render('wrapper_class.php.twig', [
             'class' => $wrapperClass,
             'library_path' => $libraryPath,
+            'ffi_accessor' => $ffiAccessor ?? '',
         ]);
     }
 
@@ -188,8 +239,7 @@ class TemplateEngine
     {
         // Function to map C types to PHP types
         $this->twig->addFunction(new \Twig\TwigFunction('php_type', function (string $cType): string {
-            $typeMapper = new TypeMapper();
-            return $typeMapper->mapCTypeToPhp($cType);
+            return $this->typeMapper->mapCTypeToPhp($cType);
         }));
 
         // Function to get default value for PHP type
@@ -206,8 +256,7 @@ class TemplateEngine
 
         // Function to generate parameter validation
         $this->twig->addFunction(new \Twig\TwigFunction('validation_code', function (string $paramName, string $cType): string {
-            $typeMapper = new TypeMapper();
-            return $typeMapper->generateValidation($paramName, $cType);
+            return $this->typeMapper->generateValidation($paramName, $cType);
         }));
     }
 
@@ -255,6 +304,9 @@ class {{ class.name }}
 {{ property|raw }}
 {% endfor %}
 
+{% if ffi_accessor %}
+{{ ffi_accessor|raw }}
+{% else %}
     /**
      * Get FFI instance from Bootstrap
      *
@@ -264,6 +316,7 @@ class {{ class.name }}
     {
         return Bootstrap::getFFI();
     }
+{% endif %}
 
 {% for method in class.methods %}
 {{ method|raw }}
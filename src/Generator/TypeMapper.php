@@ -30,6 +30,41 @@ class TypeMapper
         'size_t' => 'int',
         'bool' => 'bool',
         '_Bool' => 'bool',
+        'signed char' => 'int',
+        'long long' => 'int',
+        'unsigned long long' => 'int',
+        'int8_t' => 'int',
+        'int16_t' => 'int',
+        'int32_t' => 'int',
+        'int64_t' => 'int',
+        'uint8_t' => 'int',
+        'uint16_t' => 'int',
+        'uint32_t' => 'int',
+        'uint64_t' => 'int',
+    ];
+
+    /**
+     * @var array<string, array{0: int, 1: int|null}> Value ranges of C integer types narrower than a PHP int,
+     *      a null upper bound means only the sign is checked
+     */
+    private array $integerRanges = [
+        'char' => [-128, 127],
+        'signed char' => [-128, 127],
+        'int8_t' => [-128, 127],
+        'unsigned char' => [0, 255],
+        'uint8_t' => [0, 255],
+        'short' => [-32768, 32767],
+        'int16_t' => [-32768, 32767],
+        'unsigned short' => [0, 65535],
+        'uint16_t' => [0, 65535],
+        'int' => [-2147483648, 2147483647],
+        'int32_t' => [-2147483648, 2147483647],
+        'unsigned int' => [0, 4294967295],
+        'uint32_t' => [0, 4294967295],
+        'unsigned long' => [0, null],
+        'unsigned long long' => [0, null],
+        'uint64_t' => [0, null],
+        'size_t' => [0, null],
     ];
 
     /**
@@ -137,40 +172,42 @@ class TypeMapper
      *
      * @param string $paramName Parameter name
      * @param string $cType C type
+     * @param bool $nullable Whether null is a legal argument and skips the check
      * @return string Validation code
      */
-    public function generateValidation(string $paramName, string $cType): string
+    public function generateValidation(string $paramName, string $cType, bool $nullable = false): string
     {
         $phpType = $this->mapCTypeToPhp($cType);
+        $guard = $nullable ? "\${$paramName} !== null && " : '';
         $validation = '';
         
         switch ($phpType) {
             case 'int':
-                $validation .= "        if (!is_int(\${$paramName})) {\n";
+                $validation .= "        if ({$guard}!is_int(\${$paramName})) {\n";
                 $validation .= "            throw new \\InvalidArgumentException('Parameter {$paramName} must be an integer');\n";
                 $validation .= "        }\n";
                 break;
                 
             case 'float':
-                $validation .= "        if (!is_numeric(\${$paramName})) {\n";
+                $validation .= "        if ({$guard}!is_numeric(\${$paramName})) {\n";
                 $validation .= "            throw new \\InvalidArgumentException('Parameter {$paramName} must be numeric');\n";
                 $validation .= "        }\n";
                 break;
                 
             case 'string':
-                $validation .= "        if (!is_string(\${$paramName})) {\n";
+                $validation .= "        if ({$guard}!is_string(\${$paramName})) {\n";
                 $validation .= "            throw new \\InvalidArgumentException('Parameter {$paramName} must be a string');\n";
                 $validation .= "        }\n";
                 break;
                 
             case 'bool':
-                $validation .= "        if (!is_bool(\${$paramName})) {\n";
+                $validation .= "        if ({$guard}!is_bool(\${$paramName})) {\n";
                 $validation .= "            throw new \\InvalidArgumentException('Parameter {$paramName} must be a boolean');\n";
                 $validation .= "        }\n";
                 break;
                 
             case 'array':
-                $validation .= "        if (!is_array(\${$paramName})) {\n";
+                $validation .= "        if ({$guard}!is_array(\${$paramName})) {\n";
                 $validation .= "            throw new \\InvalidArgumentException('Parameter {$paramName} must be an array');\n";
                 $validation .= "        }\n";
                 break;
@@ -179,6 +216,82 @@ class TypeMapper
         return $validation;
     }
 
+    /**
+     * Generate range validation code for a narrow C integer parameter
+     *
+     * @param string $paramName Parameter name
+     * @param string $cType C type
+     * @param bool $nullable Whether null is a legal argument and skips the check
+     * @return string Validation code, empty when the C type holds any PHP int
+     */
+    public function generateRangeValidation(string $paramName, string $cType, bool $nullable = false): string
+    {
+        $cleanType = trim(preg_replace('/^const\s+/', '', trim($cType)));
+
+        if (!isset($this->integerRanges[$cleanType])) {
+            return '';
+        }
+
+        [$min, $max] = $this->integerRanges[$cleanType];
+        $guard = $nullable ? "\${$paramName} !== null && " : '';
+
+        if ($max === null) {
+            $validation = "        if ({$guard}\${$paramName} < {$min}) {\n";
+            $validation .= "            throw new \\OutOfRangeException('Parameter {$paramName} must not be negative ({$cleanType})');\n";
+        } else {
+            $condition = "\${$paramName} < {$min} || \${$paramName} > {$max}";
+            $validation = "        if (" . ($nullable ? "{$guard}({$condition})" : $condition) . ") {\n";
+            $validation .= "            throw new \\OutOfRangeException('Parameter {$paramName} must be between {$min} and {$max} ({$cleanType})');\n";
+        }
+        $validation .= "        }\n";
+
+        return $validation;
+    }
+
+    /**
+     * Get the pointee of a scalar out-parameter
+     *
+     * A non-const pointer to a numeric or boolean type is treated as a value the
+     * function writes back. Character pointers are strings and are excluded.
+     *
+     * @param string $cType C type
+     * @return string|null Pointee C type, null if the type is not a scalar out-pointer
+     */
+    public function getOutPointerType(string $cType): ?string
+    {
+        $cleanType = preg_replace('/\s+/', ' ', trim($cType));
+
+        if (!str_ends_with($cleanType, '*') || str_starts_with($cleanType, 'const ')) {
+            return null;
+        }
+
+        $baseType = trim(substr($cleanType, 0, -1));
+
+        if (str_contains($baseType, '*') || str_contains($baseType, 'char')) {
+            return null;
+        }
+
+        $phpType = $this->typeMap[$baseType] ?? null;
+
+        return in_array($phpType, ['int', 'float', 'bool'], true) ? $baseType : null;
+    }
+
+    /**
+     * Get the abstract type of a function pointer parameter
+     *
+     * @param string $cType C type, e.g. "void (*f)(uiButton *sender, void *data)"
+     * @return string|null Type without the parameter name, e.g. "void (*)(uiButton *sender, void *data)",
+     *         null if the type is not a function pointer
+     */
+    public function getCallbackType(string $cType): ?string
+    {
+        if (!preg_match('/^(.+?)\(\s*\*\s*\w*\s*\)\s*(\(.*\))$/s', trim($cType), $matches)) {
+            return null;
+        }
+
+        return trim($matches[1]) . ' (*)' . preg_replace('/\s+/', ' ', $matches[2]);
+    }
+
     /**
      * Check if a C type is a pointer type
      *
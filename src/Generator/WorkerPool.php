@@ -0,0 +1,247 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Generator;
+
+use Symfony\Component\Process\Process;
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Runs one task per partition in parallel worker processes
+ *
+ * Workers are forked with pcntl and posix when available and inherit the parent's
+ * state, so the task closure runs as is. Otherwise every partition is
+ * serialized for a worker command started through Symfony Process, which
+ * must read the payload file and write its result file itself. Either way
+ * results come back serialized through temporary files, in partition
+ * order whatever order the workers finish in.
+ *
+ * One worker is started per partition, callers bound the number of
+ * partitions by the number of jobs. Forked workers end by SIGKILL once their
+ * result is written, without running the shutdown functions and destructors
+ * inherited from the parent.
+ */
+class WorkerPool
+{
+    /**
+     * Timeout of one Process worker in seconds
+     */
+    private const TIMEOUT = 600;
+
+    private bool $fork;
+
+    /**
+     * @param bool|null $fork Fork workers, by default when pcntl and posix are available
+     */
+    public function __construct(?bool $fork = null)
+    {
+        $this->fork = $fork ?? (function_exists('pcntl_fork') && function_exists('pcntl_waitpid') && function_exists('posix_kill'));
+    }
+
+    /**
+     * Run a task for every partition in parallel
+     *
+     * @param array<int, mixed> $partitions Task inputs, one worker each, at most as many as jobs
+     * @param \Closure(mixed): mixed $task Task run in forked workers
+     * @param array<string> $workerCommand Command run by Process workers, called with the payload and result file paths
+     * @return array<int, mixed> Task results in partition order
+     * @throws GenerationException If a worker fails
+     */
+    public function map(array $partitions, \Closure $task, array $workerCommand): array
+    {
+        $resultFiles = [];
+
+        try {
+            foreach (array_keys($partitions) as $index) {
+                $resultFiles[$index] = $this->createTemporaryFile('result');
+            }
+
+            $errors = $this->fork
+                ? $this->runForked($partitions, $task, $resultFiles)
+                : $this->runProcesses($partitions, $workerCommand, $resultFiles);
+
+            $results = [];
+            foreach ($resultFiles as $index => $resultFile) {
+                $result = self::readResult($resultFile);
+
+                if (array_key_exists('result', $result) && !isset($errors[$index])) {
+                    $results[$index] = $result['result'];
+                } else {
+                    $errors[$index] = $result['error'] ?? $errors[$index] ?? "Worker {$index} returned no result";
+                }
+            }
+        } finally {
+            foreach ($resultFiles as $resultFile) {
+                @unlink($resultFile);
+            }
+        }
+
+        if (!empty($errors)) {
+            ksort($errors);
+            throw new GenerationException('Worker failed: ' . implode('; ', array_unique($errors)));
+        }
+
+        return $results;
+    }
+
+    /**
+     * Write the result of a task for the parent process
+     *
+     * @param string $resultFile Result file path
+     * @param \Closure(): mixed $task Task to run
+     * @return bool True if the task succeeded
+     */
+    public static function writeResult(string $resultFile, \Closure $task): bool
+    {
+        try {
+            $result = ['result' => $task()];
+        } catch (\Throwable $e) {
+            $result = ['error' => $e->getMessage()];
+        }
+
+        return file_put_contents($resultFile, serialize($result)) !== false && !isset($result['error']);
+    }
+
+    /**
+     * Fork one worker per partition and wait for all of them
+     *
+     * @param array<int, mixed> $partitions Task inputs
+     * @param \Closure(mixed): mixed $task Task to run
+     * @param array<int, string> $resultFiles Result file of each partition
+     * @return array<int, string> Errors of workers that ended other than by SIGKILL
+     */
+    private function runForked(array $partitions, \Closure $task, array $resultFiles): array
+    {
+        $pids = [];
+        $errors = [];
+
+        foreach ($partitions as $index => $partition) {
+            $pid = pcntl_fork();
+
+            if ($pid === -1) {
+                $errors[$index] = 'Failed to fork a worker process';
+                break;
+            }
+
+            if ($pid === 0) {
+                // Success or failure is in the result file; SIGKILL skips the parent's
+                // shutdown functions and destructors (log handles, running processes)
+                self::writeResult($resultFiles[$index], fn() => $task($partition));
+                posix_kill(getmypid(), SIGKILL);
+            }
+
+            $pids[$index] = $pid;
+        }
+
+        foreach ($pids as $index => $pid) {
+            pcntl_waitpid($pid, $status);
+
+            // Workers end by SIGKILL once their result is written, any other end is a failure
+            if (pcntl_wifexited($status)) {
+                $errors[$index] = sprintf('Worker %d exited with status %d', $index, pcntl_wexitstatus($status));
+            } elseif (!pcntl_wifsignaled($status) || pcntl_wtermsig($status) !== SIGKILL) {
+                $errors[$index] = "Worker {$index} exited abnormally";
+            }
+        }
+
+        return $errors;
+    }
+
+    /**
+     * Start one worker command per partition and wait for all of them
+     *
+     * @param array<int, mixed> $partitions Task inputs
+     * @param array<string> $workerCommand Worker command prefix
+     * @param array<int, string> $resultFiles Result file of each partition
+     * @return array<int, string> Errors of workers that failed without a result
+     */
+    private function runProcesses(array $partitions, array $workerCommand, array $resultFiles): array
+    {
+        $payloadFiles = [];
+        $running = [];
+        $errors = [];
+
+        try {
+            foreach ($partitions as $index => $partition) {
+                $payloadFiles[$index] = $this->createTemporaryFile('payload');
+
+                if (file_put_contents($payloadFiles[$index], serialize($partition)) === false) {
+                    throw new GenerationException("Failed to write worker payload {$payloadFiles[$index]}");
+                }
+
+                $process = new Process([...$workerCommand, $payloadFiles[$index], $resultFiles[$index]]);
+                $process->setTimeout(self::TIMEOUT);
+                $process->start();
+                $running[$index] = $process;
+            }
+
+            while (!empty($running)) {
+                foreach ($running as $index => $process) {
+                    $process->checkTimeout();
+
+                    if ($process->isRunning()) {
+                        continue;
+                    }
+
+                    unset($running[$index]);
+
+                    if (!$process->isSuccessful()) {
+                        $errors[$index] = sprintf(
+                            'Worker %d failed with exit code %d: %s',
+                            $index,
+                            $process->getExitCode(),
+                            trim($process->getErrorOutput() ?: $process->getOutput())
+                        );
+                    }
+                }
+
+                usleep(10000);
+            }
+        } catch (\Exception $e) {
+            throw new GenerationException('Failed to run worker processes: ' . $e->getMessage(), 0, $e);
+        } finally {
+            foreach ($running as $process) {
+                $process->stop(0);
+            }
+
+            foreach ($payloadFiles as $payloadFile) {
+                @unlink($payloadFile);
+            }
+        }
+
+        return $errors;
+    }
+
+    /**
+     * Read the result a worker wrote
+     *
+     * @param string $resultFile Result file path
+     * @return array{result?: mixed, error?: string} Result or error, empty if the worker wrote nothing
+     */
+    private static function readResult(string $resultFile): array
+    {
+        $content = @file_get_contents($resultFile);
+        $result = $content ? @unserialize($content) : false;
+
+        return is_array($result) ? $result : [];
+    }
+
+    /**
+     * Create a temporary file for worker data
+     *
+     * @param string $kind Kind of data, part of the file name
+     * @return string File path
+     * @throws GenerationException If the file cannot be created
+     */
+    private function createTemporaryFile(string $kind): string
+    {
+        $file = tempnam(sys_get_temp_dir(), "ffi-worker-{$kind}-");
+
+        if ($file === false) {
+            throw new GenerationException('Failed to create a temporary file for a worker');
+        }
+
+        return $file;
+    }
+}
\ No newline at end of file
@@ -15,13 +15,15 @@ class WrapperClass
      * @param array<string> $methods Generated methods
      * @param array<string> $properties Generated properties
      * @param array<string, mixed> $constants Generated constants
+     * @param array<string> $interfaces Fully qualified interfaces the class implements
      */
     public function __construct(
         public readonly string $name,
         public readonly string $namespace,
         public readonly array $methods,
         public readonly array $properties,
-        public readonly array $constants
+        public readonly array $constants,
+        public readonly array $interfaces = []
     ) {
     }
 }
\ No newline at end of file
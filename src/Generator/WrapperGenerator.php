@@ -4,9 +4,17 @@ declare(strict_types=1);
 
 namespace Yangweijie\CWrapper\Generator;
 
+use Yangweijie\CWrapper\Analyzer\FunctionSignature;
+use Yangweijie\CWrapper\Analyzer\HeaderAnalyzer;
+use Yangweijie\CWrapper\Analyzer\HeaderPreprocessor;
+use Yangweijie\CWrapper\Analyzer\StructureDefinition;
+use Yangweijie\CWrapper\Exception\AnalysisException;
 use Yangweijie\CWrapper\Integration\ProcessedBindings;
 use Yangweijie\CWrapper\Documentation\Documentation;
+use Yangweijie\CWrapper\Config\GenerationConfig;
 use Yangweijie\CWrapper\Config\ProjectConfig;
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Profiler\SharedStatsSegment;
 
 /**
  * Main wrapper generator that coordinates all sub-generators
@@ -18,140 +26,949 @@ class WrapperGenerator implements GeneratorInterface
     private ConstantGenerator $constantGenerator;
     private TemplateEngine $templateEngine;
     private MethodGenerator $methodGenerator;
+    private DeclarationBuilder $declarationBuilder;
+    private BatchShimGenerator $batchShimGenerator;
+    private HeaderAnalyzer $headerAnalyzer;
+    private TypeMapper $typeMapper;
+
+    /**
+     * Header file written next to the generated classes in preload mode
+     */
+    private const SCOPE_HEADER = 'ffi_scope.h';
+
+    /**
+     * PHP file returning the C declarations when stored outside the Bootstrap class
+     */
+    private const DECLARATIONS_FILE = 'declarations.php';
+
+    /**
+     * Number of recent calls kept by the Bootstrap profiler of instrumented builds
+     */
+    private const PROFILE_BUFFER_SIZE = 4096;
+
+    /**
+     * Console script running the render-worker command for Process workers
+     */
+    private const WORKER_SCRIPT = __DIR__ . '/../../bin/c-to-php-ffi';
 
     public function __construct(
         ?ClassGenerator $classGenerator = null,
         ?StructGenerator $structGenerator = null,
         ?ConstantGenerator $constantGenerator = null,
         ?TemplateEngine $templateEngine = null,
-        ?MethodGenerator $methodGenerator = null
+        ?MethodGenerator $methodGenerator = null,
+        ?DeclarationBuilder $declarationBuilder = null,
+        ?BatchShimGenerator $batchShimGenerator = null,
+        ?HeaderAnalyzer $headerAnalyzer = null,
+        ?TypeMapper $typeMapper = null
     ) {
-        $this->templateEngine = $templateEngine ?? new TemplateEngine();
-        $this->methodGenerator = $methodGenerator ?? new MethodGenerator();
+        $this->typeMapper = $typeMapper ?? new TypeMapper();
+        $this->templateEngine = $templateEngine ?? new TemplateEngine(typeMapper: $this->typeMapper);
+        $this->methodGenerator = $methodGenerator ?? new MethodGenerator($this->typeMapper);
         $this->classGenerator = $classGenerator ?? new ClassGenerator($this->methodGenerator, $this->templateEngine);
-        $this->structGenerator = $structGenerator ?? new StructGenerator(null, $this->templateEngine);
+        $this->structGenerator = $structGenerator ?? new StructGenerator($this->typeMapper, $this->templateEngine);
         $this->constantGenerator = $constantGenerator ?? new ConstantGenerator($this->templateEngine);
+        $this->declarationBuilder = $declarationBuilder ?? new DeclarationBuilder();
+        $this->batchShimGenerator = $batchShimGenerator ?? new BatchShimGenerator();
+        $this->headerAnalyzer = $headerAnalyzer ?? new HeaderAnalyzer();
+    }
+
+    /**
+     * Generate wrapper code from processed bindings
+     *
+     * Holds every class in memory; use emit() to write large libraries.
+     *
+     * @param ProcessedBindings $bindings Processed bindings to generate from
+     * @param ProjectConfig|null $config Project configuration for namespace and other settings
+     * @return GeneratedCode Generated code result
+     */
+    public function generate(ProcessedBindings $bindings, ?ProjectConfig $config = null): GeneratedCode
+    {
+        $plan = $this->planGeneration($bindings, $config);
+        $classes = [];
+
+        foreach ([$this->generateFunctionClasses($plan), $this->generateDataClasses($plan, $bindings, $config)] as $source) {
+            foreach ($source as $class) {
+                $classes[] = $class;
+            }
+        }
+
+        $files = [];
+        if ($config) {
+            [$bootstrapClass, $files] = $this->generateBootstrap(
+                $plan,
+                $config,
+                array_map(fn(WrapperClass $class) => $class->name, $classes)
+            );
+            $classes[] = $bootstrapClass;
+        }
+
+        return new GeneratedCode($classes, [], [], $this->generateDocumentation($classes, $config), $files);
+    }
+
+    /**
+     * Stream the generated files of processed bindings
+     *
+     * Each class file is rendered as soon as its class is complete and its
+     * methods are released once the file is yielded, so peak memory is
+     * bounded by the largest single class rather than the whole library.
+     * With more than one job, function group classes are rendered by a
+     * WorkerPool instead and yielded in the same order once all are done.
+     * Struct, constants and Bootstrap classes, support files and README.md
+     * follow.
+     *
+     * @param ProcessedBindings $bindings Processed bindings to generate from
+     * @param ProjectConfig $config Project configuration
+     * @return \Generator<string, string> Filename relative to the output path => content, returns the number of classes
+     */
+    public function emit(ProcessedBindings $bindings, ProjectConfig $config): \Generator
+    {
+        $plan = $this->planGeneration($bindings, $config);
+        $jobs = $config->getGenerationConfig()->getJobs();
+
+        $functionClasses = $jobs > 1
+            ? $this->renderFunctionClassesInParallel($plan, $config, $jobs)
+            : $this->renderClasses($this->generateFunctionClasses($plan), $config);
+        $dataClasses = $this->renderClasses($this->generateDataClasses($plan, $bindings, $config), $config);
+
+        $classes = [];
+        foreach ([$functionClasses, $dataClasses] as $source) {
+            foreach ($source as $rendered) {
+                yield $rendered['filename'] => $rendered['content'];
+
+                // The Bootstrap and documentation only need to know which classes exist
+                $classes[] = new WrapperClass($rendered['name'], $rendered['namespace'], [], [], []);
+            }
+        }
+
+        [$bootstrapClass, $files] = $this->generateBootstrap(
+            $plan,
+            $config,
+            array_map(fn(WrapperClass $class) => $class->name, $classes)
+        );
+        yield $this->getClassFilename($bootstrapClass) => $this->renderClass($bootstrapClass, $config);
+        $classes[] = $bootstrapClass;
+
+        yield from $files;
+        yield 'README.md' => $this->generateDocumentation($classes, $config)->readmeContent;
+
+        return count($classes);
+    }
+
+    /**
+     * Render the classes of some function groups
+     *
+     * Entry point of the Process workers of a parallel emit(), which receive
+     * the plan of the parent instead of analyzing the headers again.
+     *
+     * @param array<string, mixed> $plan Generation plan
+     * @param ProjectConfig $config Project configuration
+     * @param array<string> $groupNames Function groups to render
+     * @return array<string, array{name: string, namespace: string, filename: string, content: string}> Rendered classes keyed by group name
+     */
+    public function renderFunctionGroups(array $plan, ProjectConfig $config, array $groupNames): array
+    {
+        return iterator_to_array($this->renderClasses($this->generateFunctionClasses($plan, $groupNames), $config));
+    }
+
+    /**
+     * Generate all code files from generated code
+     *
+     * @param GeneratedCode $generatedCode Generated code to write
+     * @param ProjectConfig $config Project configuration
+     * @return array<string, string> Array of filename => content
+     */
+    public function generateCodeFiles(GeneratedCode $generatedCode, ProjectConfig $config): array
+    {
+        $files = [];
+
+        foreach ($generatedCode->classes as $class) {
+            $files[$this->getClassFilename($class)] = $this->renderClass($class, $config);
+        }
+
+        // Add support files such as the preload script
+        foreach ($generatedCode->files as $filename => $content) {
+            $files[$filename] = $content;
+        }
+
+        return $files;
+    }
+
+    /**
+     * Collect everything the class generation stages share
+     *
+     * @param ProcessedBindings $bindings Processed bindings to generate from
+     * @param ProjectConfig|null $config Project configuration for namespace and other settings
+     * @return array{namespace: string, generationType: string, declarations: array<array{kind: string, name: string, code: string}>, scopeDeclarations: array<array{kind: string, name: string, code: string}>|null, directDispatch: bool, profile: string, outParams: bool, instrument: bool, functions: array<FunctionSignature>, structures: array<StructureDefinition>, batchFunctions: array<string, FunctionSignature>, ffigenFunctions: array<string, array>} Generation plan
+     * @throws GenerationException If split scopes are combined with callback parameters
+     */
+    private function planGeneration(ProcessedBindings $bindings, ?ProjectConfig $config): array
+    {
+        $generationType = $config ? $config->getGenerationType() : 'object';
+
+        // Parse the C declarations once, they feed the Bootstrap and any per-class scopes
+        $declarations = $config ? $this->declarationBuilder->collect($config->getHeaderFiles()) : [];
+
+        // The bindings only carry PHP types and struct names, take C signatures and fields from the headers
+        $headerDefinitions = $config ? $this->analyzeHeaders($config) : ['functions' => [], 'structures' => []];
+        $functions = $this->withHeaderSignatures($bindings->functions, $headerDefinitions['functions']);
+
+        $scopeDeclarations = $config && $generationType === 'object' && $config->getGenerationConfig()->isSplitScopesEnabled()
+            ? $declarations
+            : null;
+
+        // FFI types of different scopes are incompatible, and CallbackRegistry converts closures in the Bootstrap scope
+        if ($scopeDeclarations !== null && $this->hasCallbackParameters($functions)) {
+            throw new GenerationException(
+                'Split scopes cannot be combined with function pointer parameters, callbacks are created in the shared Bootstrap scope'
+            );
+        }
+
+        // Use improved generation when the ffigen trait is known, parsed once into the binding IR
+        $methodsFilePath = ($config ? $config->getOutputPath() : './generated') . '/Methods.php';
+
+        return [
+            'namespace' => $config ? $config->getNamespace() : 'Generated\\Wrapper',
+            'generationType' => $generationType,
+            'declarations' => $declarations,
+            'scopeDeclarations' => $scopeDeclarations,
+            'directDispatch' => $config && $config->getGenerationConfig()->isDirectDispatchEnabled(),
+            'profile' => $config ? $config->getGenerationConfig()->getProfile() : GenerationConfig::PROFILE_DEBUG,
+            'outParams' => $config && $config->getGenerationConfig()->isOutParamsEnabled(),
+            'instrument' => $config && $config->getGenerationConfig()->isInstrumentEnabled(),
+            'functions' => $functions,
+            'structures' => $this->withHeaderStructures($bindings->structures, $headerDefinitions['structures']),
+            'batchFunctions' => $config
+                ? $this->selectBatchFunctions($functions, $config->getGenerationConfig()->getBatchFunctions())
+                : [],
+            'ffigenFunctions' => $bindings->ir?->functions
+                ?? (file_exists($methodsFilePath) ? (new FFIGenOutputParser())->parseMethodsFile($methodsFilePath) : []),
+        ];
+    }
+
+    /**
+     * Generate the function group classes
+     *
+     * @param array<string, mixed> $plan Generation plan
+     * @param array<string>|null $groupNames Only generate these groups, null for all
+     * @return \Generator<string, WrapperClass> Classes keyed by function group
+     */
+    private function generateFunctionClasses(array $plan, ?array $groupNames = null): \Generator
+    {
+        $only = $groupNames === null ? null : array_flip($groupNames);
+
+        if (!empty($plan['ffigenFunctions'])) {
+            return $this->generateImprovedClasses(
+                $plan['ffigenFunctions'],
+                $plan['namespace'],
+                $plan['generationType'],
+                $plan['scopeDeclarations'],
+                $plan['directDispatch'],
+                $plan['profile'],
+                $plan['outParams'],
+                $plan['instrument'],
+                $plan['functions'],
+                $plan['batchFunctions'],
+                $only
+            );
+        }
+
+        return $this->generateFallbackClasses(
+            $plan['functions'],
+            $plan['namespace'],
+            $plan['generationType'],
+            $plan['scopeDeclarations'],
+            $plan['directDispatch'],
+            $plan['profile'],
+            $plan['outParams'],
+            $plan['instrument'],
+            $plan['batchFunctions'],
+            $only
+        );
+    }
+
+    /**
+     * Render function group classes in parallel worker processes
+     *
+     * Groups are spread over the workers by estimated size, the number of
+     * functions and parameters they wrap; results are put back in group
+     * order, so the output is the same as with a single job.
+     *
+     * @param array<string, mixed> $plan Generation plan, sent to Process workers
+     * @param ProjectConfig $config Project configuration
+     * @param int $jobs Number of workers
+     * @return iterable<array{name: string, namespace: string, filename: string, content: string}> Rendered classes
+     * @throws GenerationException If a worker fails
+     */
+    private function renderFunctionClassesInParallel(array $plan, ProjectConfig $config, int $jobs): iterable
+    {
+        $groupSizes = $this->getFunctionGroupSizes($plan);
+
+        if (count($groupSizes) < 2) {
+            return $this->renderClasses($this->generateFunctionClasses($plan), $config);
+        }
+
+        // Function classes need neither the full declarations nor the structures
+        $workerPlan = array_diff_key($plan, ['declarations' => true, 'structures' => true]);
+        $partitions = array_map(
+            fn(array $groupNames) => [$workerPlan, $config, $groupNames],
+            $this->partitionFunctionGroups($groupSizes, $jobs)
+        );
+
+        $results = (new WorkerPool())->map(
+            $partitions,
+            fn(array $partition) => $this->renderFunctionGroups($workerPlan, $config, $partition[2]),
+            [PHP_BINARY, self::WORKER_SCRIPT, 'render-worker']
+        );
+
+        $rendered = [];
+        foreach ($results as $result) {
+            $rendered += $result;
+        }
+
+        $ordered = [];
+        foreach (array_keys($groupSizes) as $groupName) {
+            if (isset($rendered[$groupName])) {
+                $ordered[] = $rendered[$groupName];
+            }
+        }
+
+        return $ordered;
+    }
+
+    /**
+     * Estimate the rendering cost of each function group
+     *
+     * @param array<string, mixed> $plan Generation plan
+     * @return array<string, int> Functions plus parameters of each group, in generation order
+     */
+    private function getFunctionGroupSizes(array $plan): array
+    {
+        if ($plan['generationType'] !== 'object') {
+            return ['Functions' => count($plan['ffigenFunctions'] ?: $plan['functions'])];
+        }
+
+        $sizes = [];
+
+        if (!empty($plan['ffigenFunctions'])) {
+            $groups = (new FFIGenOutputParser())->groupFunctionsBySemantics($plan['ffigenFunctions']);
+
+            foreach ($groups as $groupName => $functionNames) {
+                $sizes[$groupName] = 0;
+                foreach ($functionNames as $functionName) {
+                    $sizes[$groupName] += 1 + count($plan['ffigenFunctions'][$functionName]['parameters'] ?? []);
+                }
+            }
+
+            return $sizes;
+        }
+
+        foreach ($this->groupFunctionsByPrefix($plan['functions']) as $groupName => $groupFunctions) {
+            $sizes[$groupName] = 0;
+            foreach ($groupFunctions as $function) {
+                $sizes[$groupName] += 1 + count($function->parameters);
+            }
+        }
+
+        return $sizes;
+    }
+
+    /**
+     * Spread function groups over workers, the largest group first to the least loaded worker
+     *
+     * @param array<string, int> $groupSizes Estimated size of each group
+     * @param int $jobs Number of workers
+     * @return array<int, array<string>> Group names of each worker
+     */
+    private function partitionFunctionGroups(array $groupSizes, int $jobs): array
+    {
+        arsort($groupSizes);
+        $count = min($jobs, count($groupSizes));
+        $partitions = array_fill(0, $count, []);
+        $weights = array_fill(0, $count, 0);
+
+        foreach ($groupSizes as $groupName => $size) {
+            $lightest = array_keys($weights, min($weights), true)[0];
+            $partitions[$lightest][] = (string) $groupName;
+            $weights[$lightest] += $size;
+        }
+
+        return $partitions;
+    }
+
+    /**
+     * Render generated classes one at a time
+     *
+     * @param iterable<WrapperClass> $classes Generated classes
+     * @param ProjectConfig $config Project configuration
+     * @return \Generator<array{name: string, namespace: string, filename: string, content: string}> Rendered classes, keys preserved
+     */
+    private function renderClasses(iterable $classes, ProjectConfig $config): \Generator
+    {
+        foreach ($classes as $key => $class) {
+            yield $key => [
+                'name' => $class->name,
+                'namespace' => $class->namespace,
+                'filename' => $this->getClassFilename($class),
+                'content' => $this->renderClass($class, $config),
+            ];
+        }
+    }
+
+    /**
+     * Generate the Bootstrap class and the support files
+     *
+     * @param array<string, mixed> $plan Generation plan
+     * @param ProjectConfig $config Project configuration
+     * @param array<string> $classNames Classes generated so far, precompiled by the preload script
+     * @return array{WrapperClass, array<string, string>} Bootstrap class and support files (filename => content)
+     */
+    private function generateBootstrap(array $plan, ProjectConfig $config, array $classNames): array
+    {
+        $functions = $plan['functions'];
+        $batchFunctions = $plan['batchFunctions'];
+
+        // Only declare what the wrappers call, FFI::cdef() fails on unresolved symbols
+        $declarations = $this->declarationBuilder->render($this->declarationBuilder->filter(
+            $plan['declarations'],
+            array_map(fn($function) => $function->name, $functions)
+        ));
+
+        // Shared statistics slots follow the ffigen function list the improved wrappers are built from
+        $functionNames = !empty($plan['ffigenFunctions'])
+            ? array_keys($plan['ffigenFunctions'])
+            : array_map(fn($function) => $function->name, $functions);
+
+        $bootstrapClass = $this->generateBootstrapClass(
+            $config,
+            $plan['namespace'],
+            $declarations,
+            $batchFunctions,
+            $functionNames
+        );
+        $classNames[] = $bootstrapClass->name;
+
+        $files = [];
+        if ($config->getGenerationConfig()->isPreloadEnabled()) {
+            $files = $this->generatePreloadFiles($config, $classNames, $declarations);
+        } elseif ($config->getGenerationConfig()->getDeclarationStorage() === 'file') {
+            $files[self::DECLARATIONS_FILE] = "<?php\n\ndeclare(strict_types=1);\n\nreturn " . var_export($declarations, true) . ";\n";
+        }
+
+        if ($this->hasCallbackParameters($functions)) {
+            $files['CallbackRegistry.php'] = $this->generateCallbackRegistryCode($plan['namespace']);
+        }
+
+        if (!empty($batchFunctions)) {
+            $files[basename($config->getBatchSourceFile())] = $this->batchShimGenerator->generateSource(
+                $batchFunctions,
+                $config->getHeaderFiles()
+            );
+        }
+
+        return [$bootstrapClass, $files];
+    }
+
+    /**
+     * Generate function group classes from the binding signatures
+     *
+     * Used when no ffigen trait is available.
+     *
+     * @param array<\Yangweijie\CWrapper\Analyzer\FunctionSignature> $functions Functions to wrap
+     * @param string $baseNamespace Base namespace
+     * @param string $generationType Generation type
+     * @param array<array{kind: string, name: string, code: string}>|null $scopeDeclarations Declarations to slice per class, null for a shared scope
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
+     * @param array<string, \Yangweijie\CWrapper\Analyzer\FunctionSignature> $batchFunctions Functions that also get a batch method
+     * @param array<string, int>|null $only Group names to generate as keys, null for all
+     * @return \Generator<string, WrapperClass> Generated wrapper classes keyed by function group
+     */
+    private function generateFallbackClasses(
+        array $functions,
+        string $baseNamespace,
+        string $generationType,
+        ?array $scopeDeclarations,
+        bool $directDispatch,
+        string $profile,
+        bool $outParams,
+        bool $instrument,
+        array $batchFunctions,
+        ?array $only = null
+    ): \Generator {
+        if ($generationType !== 'object') {
+            if ($only !== null && !isset($only['Functions'])) {
+                return;
+            }
+
+            $wrapperClass = $this->withBatchMethods(
+                $this->generateFunctionalWrapper($functions, $baseNamespace, $directDispatch, $profile, $outParams, $instrument),
+                array_keys($batchFunctions),
+                $batchFunctions,
+                $generationType
+            );
+
+            yield 'Functions' => $directDispatch ? $this->withCachedFFI($wrapperClass) : $wrapperClass;
+            return;
+        }
+
+        foreach ($this->groupFunctionsByPrefix($functions) as $groupName => $groupFunctions) {
+            if ($only !== null && !isset($only[$groupName])) {
+                continue;
+            }
+
+            $className = $this->convertGroupNameToClassName($groupName);
+            $functionNames = array_map(fn($function) => $function->name, $groupFunctions);
+            
+            $wrapperClass = $this->classGenerator->generateClass(
+                $className,
+                $baseNamespace,
+                $groupFunctions,
+                [],
+                [],
+                $generationType,
+                $directDispatch,
+                $profile,
+                $outParams,
+                $instrument
+            );
+
+            if ($scopeDeclarations !== null) {
+                $wrapperClass = $this->withScopeDeclarations($wrapperClass, $scopeDeclarations, $functionNames);
+            }
+
+            $wrapperClass = $this->withBatchMethods($wrapperClass, $functionNames, $batchFunctions, $generationType);
+            
+            yield $groupName => $directDispatch ? $this->withCachedFFI($wrapperClass) : $wrapperClass;
+        }
+    }
+
+    /**
+     * Generate struct classes and the constants class
+     *
+     * @param array<string, mixed> $plan Generation plan, source of the structures with their header fields
+     * @param ProcessedBindings $bindings Processed bindings, source of the constants
+     * @param ProjectConfig|null $config Project configuration
+     * @return \Generator<int, WrapperClass> Generated classes
+     */
+    private function generateDataClasses(array $plan, ProcessedBindings $bindings, ?ProjectConfig $config): \Generator
+    {
+        $baseNamespace = $plan['namespace'];
+        $cdataStructs = $config && $config->getGenerationConfig()->getStructBackend() === 'cdata';
+        foreach ($plan['structures'] as $structure) {
+            yield $cdataStructs
+                ? $this->structGenerator->generateCDataStructClass(
+                    $structure,
+                    $baseNamespace . '\\Struct',
+                    $baseNamespace . '\\Bootstrap'
+                )
+                : $this->structGenerator->generateStructClass(
+                    $structure,
+                    $baseNamespace . '\\Struct'
+                );
+
+            yield $this->structGenerator->generateStructArrayClass(
+                $structure,
+                $baseNamespace . '\\Struct',
+                $baseNamespace . '\\Bootstrap',
+                $cdataStructs
+            );
+        }
+
+        // Generate constants class if there are constants
+        if (!empty($bindings->constants)) {
+            yield $this->constantGenerator->generateConstantsClass(
+                $bindings->constants,
+                $baseNamespace,
+                'Constants'
+            );
+        }
+    }
+
+    /**
+     * Render the file content of a generated class
+     *
+     * @param WrapperClass $class Generated class
+     * @param ProjectConfig $config Project configuration
+     * @return string File content
+     */
+    private function renderClass(WrapperClass $class, ProjectConfig $config): string
+    {
+        // Determine the type of class and generate appropriate code
+        if ($class->name === 'Bootstrap') {
+            // Special handling for Bootstrap class
+            return $this->generateBootstrapClassCode($class);
+        }
+
+        if (str_contains($class->namespace, 'Struct')) {
+            // This is a struct class - we need the original structure definition
+            // For now, use the legacy method
+            return $this->generateStructClassContent($class);
+        }
+
+        if (str_contains($class->namespace, 'Constants')) {
+            return $this->constantGenerator->generateConstantsClassCode($class);
+        }
+
+        return $this->classGenerator->generateClassCode(
+            $class,
+            $config->getLibraryFile(),
+            $this->generateFFIAccessor($config)
+        );
+    }
+
+    /**
+     * Generate the getFFI() method used by function group classes
+     *
+     * @param ProjectConfig $config Project configuration
+     * @return string|null Method code, null to delegate to Bootstrap::getFFI()
+     */
+    private function generateFFIAccessor(ProjectConfig $config): ?string
+    {
+        if ($config->getGenerationType() !== 'object' || !$config->getGenerationConfig()->isSplitScopesEnabled()) {
+            return null;
+        }
+
+        return '    /**
+     * Get FFI instance scoped to this class
+     *
+     * Only the declarations used by this class are parsed, on first use.
+     *
+     * @return FFI FFI instance
+     */
+    protected static function getFFI(): FFI
+    {
+        return self::$ffi ??= FFI::cdef(self::CDEF, Bootstrap::LIBRARY_PATH);
+    }';
+    }
+
+    /**
+     * Attach the minimal declaration slice for a function group to its class
+     *
+     * @param WrapperClass $class Function group class
+     * @param array<array{kind: string, name: string, code: string}> $declarations All parsed declarations
+     * @param array<string> $functionNames Functions wrapped by the class
+     * @return WrapperClass Class with its own FFI handle and CDEF constant
+     */
+    private function withScopeDeclarations(WrapperClass $class, array $declarations, array $functionNames): WrapperClass
+    {
+        $slice = $this->declarationBuilder->render($this->declarationBuilder->slice($declarations, $functionNames));
+
+        $class = $this->withCachedFFI($class);
+
+        return new WrapperClass(
+            $class->name,
+            $class->namespace,
+            $class->methods,
+            array_merge($class->properties, ['    private const CDEF = ' . var_export($slice, true) . ';']),
+            $class->constants
+        );
+    }
+
+    /**
+     * Analyze the input headers for their function signatures and structures
+     *
+     * @param ProjectConfig $config Project configuration, source of the headers and preprocessor options
+     * @return array{functions: array<string, FunctionSignature>, structures: array<StructureDefinition>} Header definitions, functions keyed by name
+     */
+    private function analyzeHeaders(ProjectConfig $config): array
+    {
+        $generationConfig = $config->getGenerationConfig();
+        // A generate run passes an analyzer sharing its preprocessor, only standalone use needs one here
+        $analyzer = $generationConfig->isPreprocessEnabled() && !$this->headerAnalyzer->isPreprocessing()
+            ? new HeaderAnalyzer(null, new HeaderPreprocessor(
+                $generationConfig->getDefines(),
+                $generationConfig->getIncludePaths(),
+                CacheDirectory::get($generationConfig->getCacheDir(), 'preprocessed')
+            ))
+            : $this->headerAnalyzer;
+
+        $definitions = ['functions' => [], 'structures' => []];
+        foreach ($config->getHeaderFiles() as $headerFile) {
+            try {
+                $result = $analyzer->analyze($headerFile);
+            } catch (AnalysisException) {
+                // Keep the binding definitions of headers the analyzer cannot read
+                continue;
+            }
+
+            foreach ($result->functions as $signature) {
+                $definitions['functions'][$signature->name] = $signature;
+            }
+
+            array_push($definitions['structures'], ...$result->structures);
+        }
+
+        return $definitions;
+    }
+
+    /**
+     * Replace binding signatures by the C signatures parsed from the headers
+     *
+     * A header signature is only used when it has the same named parameters,
+     * so wrapper signatures never lose a parameter.
+     *
+     * @param array<FunctionSignature> $functions Binding signatures
+     * @param array<string, FunctionSignature> $headerSignatures Header signatures keyed by name
+     * @return array<FunctionSignature> Signatures with C types where available
+     */
+    private function withHeaderSignatures(array $functions, array $headerSignatures): array
+    {
+        return array_map(function ($function) use ($headerSignatures) {
+            $signature = $headerSignatures[$function->name] ?? null;
+
+            if ($signature === null
+                || array_column($signature->parameters, 'name') !== array_column($function->parameters, 'name')) {
+                return $function;
+            }
+
+            return new FunctionSignature(
+                $signature->name,
+                $signature->returnType,
+                $signature->parameters,
+                $function->documentation
+            );
+        }, $functions);
+    }
+
+    /**
+     * Fill the binding structures with the fields parsed from the headers
+     *
+     * ffigen only names structures by their tag. A header structure matches
+     * by tag or typedef name and supplies the fields and the typedef name to
+     * allocate; the binding name is kept so class names do not change.
+     *
+     * @param array<StructureDefinition> $structures Binding structures
+     * @param array<StructureDefinition> $headerStructures Structures parsed from the headers
+     * @return array<StructureDefinition> Structures with fields where available
+     */
+    private function withHeaderStructures(array $structures, array $headerStructures): array
+    {
+        $byName = [];
+        foreach ($headerStructures as $structure) {
+            $byName[$structure->name] ??= $structure;
+            if ($structure->tag !== null) {
+                $byName[$structure->tag] ??= $structure;
+            }
+        }
+
+        return array_map(function (StructureDefinition $structure) use ($byName) {
+            $name = preg_replace('/^(struct|union)\s+/', '', $structure->name);
+            $header = $byName[$name] ?? null;
+
+            if ($header === null || !empty($structure->fields)) {
+                return $structure;
+            }
+
+            return new StructureDefinition(
+                $structure->name,
+                $header->fields,
+                $header->isUnion,
+                $header->tag,
+                $header->cType
+            );
+        }, $structures);
+    }
+
+    /**
+     * Check whether any function takes a function pointer
+     *
+     * @param array<FunctionSignature> $functions Function signatures
+     * @return bool True if a CallbackRegistry is needed
+     */
+    private function hasCallbackParameters(array $functions): bool
+    {
+        foreach ($functions as $function) {
+            foreach ($function->parameters as $param) {
+                if ($this->typeMapper->getCallbackType($param['type']) !== null) {
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    /**
+     * Generate the registry reusing function pointers created for closures
+     *
+     * @param string $namespace Base namespace
+     * @return string Class code
+     */
+    private function generateCallbackRegistryCode(string $namespace): string
+    {
+        return '<?php
+
+declare(strict_types=1);
+
+namespace ' . $namespace . ';
+
+/**
+ * Reuses the native trampolines FFI creates for closures passed as C function pointers
+ *
+ * Passing a closure straight to FFI creates a new trampoline on every call. The
+ * generated wrappers pass closures through get() instead, which converts each
+ * closure once per function pointer type and keeps it alive, so C code may
+ * call it later (e.g. event handlers). forget() drops the registry references
+ * once C no longer calls the callback. PHP FFI offers no way to free a
+ * trampoline: it keeps the native code until the end of the request.
+ */
+final class CallbackRegistry
+{
+    /**
+     * @var array<int, array{closure: \Closure, cells: array<string, \FFI\CData>}>
+     */
+    private static array $entries = [];
+
+    /**
+     * Get the function pointer for a closure, creating its trampoline on first use
+     *
+     * @param \Closure $closure PHP callback
+     * @param string $type C function pointer type, e.g. 'void (*)(int)'
+     * @return \FFI\CData Function pointer
+     */
+    public static function get(\Closure $closure, string $type): \FFI\CData
+    {
+        $id = spl_object_id($closure);
+
+        if (!isset(self::$entries[$id]["cells"][$type])) {
+            // A one-element array of the pointer type owns the converted closure
+            $cell = Bootstrap::getFFI()->new(str_replace('(*)', '(*[1])', $type));
+            $cell[0] = $closure;
+
+            self::$entries[$id]["closure"] = $closure;
+            self::$entries[$id]["cells"][$type] = $cell;
+        }
+
+        return self::$entries[$id]["cells"][$type][0];
+    }
+
+    /**
+     * Drop the function pointers created for a closure
+     *
+     * The closure may be collected afterwards, FFI keeps the trampoline until the end of the request.
+     *
+     * @param \Closure $closure PHP callback
+     */
+    public static function forget(\Closure $closure): void
+    {
+        unset(self::$entries[spl_object_id($closure)]);
+    }
+
+    /**
+     * Drop all function pointers
+     */
+    public static function clear(): void
+    {
+        self::$entries = [];
+    }
+
+    /**
+     * @return int Number of registered closures
+     */
+    public static function count(): int
+    {
+        return count(self::$entries);
+    }
+}
+';
+    }
+
+    /**
+     * Resolve the functions selected for batching
+     *
+     * @param array<\Yangweijie\CWrapper\Analyzer\FunctionSignature> $functions Available functions
+     * @param array<string> $names Function names selected for batching
+     * @return array<string, \Yangweijie\CWrapper\Analyzer\FunctionSignature> Batchable functions by name
+     * @throws GenerationException If a selected function is unknown or not scalar
+     */
+    private function selectBatchFunctions(array $functions, array $names): array
+    {
+        $byName = [];
+        foreach ($functions as $function) {
+            $byName[$function->name] = $function;
+        }
+
+        $batchFunctions = [];
+        foreach ($names as $name) {
+            if (!isset($byName[$name])) {
+                throw new GenerationException("Cannot batch unknown function: {$name}");
+            }
+
+            if (!$this->batchShimGenerator->isBatchable($byName[$name])) {
+                throw new GenerationException(
+                    "Cannot batch {$name}: parameters must share one scalar type and the return type must be scalar"
+                );
+            }
+
+            $batchFunctions[$name] = $byName[$name];
+        }
+
+        return $batchFunctions;
     }
 
     /**
-     * Generate wrapper code from processed bindings
+     * Append batch methods for the batched functions of a class
      *
-     * @param ProcessedBindings $bindings Processed bindings to generate from
-     * @param ProjectConfig|null $config Project configuration for namespace and other settings
-     * @return GeneratedCode Generated code result
+     * @param WrapperClass $class Wrapper class
+     * @param array<string> $functionNames Functions wrapped by the class
+     * @param array<string, \Yangweijie\CWrapper\Analyzer\FunctionSignature> $batchFunctions Batchable functions by name
+     * @param string $generationType Generation type
+     * @return WrapperClass Class with batch methods
      */
-    public function generate(ProcessedBindings $bindings, ?ProjectConfig $config = null): GeneratedCode
-    {
-        $classes = [];
-        $interfaces = [];
-        $traits = [];
+    private function withBatchMethods(
+        WrapperClass $class,
+        array $functionNames,
+        array $batchFunctions,
+        string $generationType
+    ): WrapperClass {
+        $methods = $class->methods;
 
-        // Determine namespace to use
-        $baseNamespace = $config ? $config->getNamespace() : 'Generated\\Wrapper';
-        $generationType = $config ? $config->getGenerationType() : 'object';
-        
-        // Try to use improved generation if Methods.php exists
-        $outputPath = $config ? $config->getOutputPath() : './generated';
-        $methodsFilePath = $outputPath . '/Methods.php';
-        
-        if (file_exists($methodsFilePath)) {
-            // Use improved generation based on klitsche/ffigen output
-            $classes = $this->generateImprovedClasses($methodsFilePath, $baseNamespace, $generationType);
-        } else {
-            // Fallback to original generation
-            if ($generationType === 'object') {
-                $functionGroups = $this->groupFunctionsByPrefix($bindings->functions);
-                
-                foreach ($functionGroups as $groupName => $functions) {
-                    $className = $this->convertGroupNameToClassName($groupName);
-                    
-                    $wrapperClass = $this->classGenerator->generateClass(
-                        $className,
-                        $baseNamespace,
-                        $functions,
-                        [],
-                        [],
-                        $generationType
-                    );
-                    
-                    $classes[] = $wrapperClass;
-                }
-            } else {
-                $wrapperClass = $this->generateFunctionalWrapper($bindings->functions, $baseNamespace);
-                $classes[] = $wrapperClass;
+        foreach ($functionNames as $functionName) {
+            if (!isset($batchFunctions[$functionName])) {
+                continue;
             }
-        }
-
-        // Generate struct classes
-        foreach ($bindings->structures as $structure) {
-            $wrapperClass = $this->structGenerator->generateStructClass(
-                $structure,
-                $baseNamespace . '\\Struct'
-            );
-            
-            $classes[] = $wrapperClass;
-        }
 
-        // Generate constants class if there are constants
-        if (!empty($bindings->constants)) {
-            $constantsClass = $this->constantGenerator->generateConstantsClass(
-                $bindings->constants,
-                $baseNamespace,
-                'Constants'
+            $function = $batchFunctions[$functionName];
+            $methods[] = $this->methodGenerator->generateBatchMethod(
+                $function,
+                $this->batchShimGenerator->getInputType($function),
+                $this->batchShimGenerator->getOutputType($function),
+                $generationType,
+                $class->name
             );
-            
-            $classes[] = $constantsClass;
         }
 
-        // Generate Bootstrap class for centralized FFI management
-        if ($config) {
-            $bootstrapClass = $this->generateBootstrapClass($config, $baseNamespace);
-            $classes[] = $bootstrapClass;
+        if (count($methods) === count($class->methods)) {
+            return $class;
         }
 
-        // Create temporary GeneratedCode object for documentation generation
-        $tempDocumentation = new Documentation([], '', []);
-        $generatedCode = new GeneratedCode($classes, $interfaces, $traits, $tempDocumentation);
-        
-        // Generate proper documentation
-        $documentation = $this->generateDocumentation($generatedCode, $config);
-
-        // Return with proper documentation
-        return new GeneratedCode($classes, $interfaces, $traits, $documentation);
+        return new WrapperClass($class->name, $class->namespace, $methods, $class->properties, $class->constants);
     }
 
     /**
-     * Generate all code files from generated code
+     * Give a wrapper class its own static FFI handle
      *
-     * @param GeneratedCode $generatedCode Generated code to write
-     * @param ProjectConfig $config Project configuration
-     * @return array<string, string> Array of filename => content
+     * @param WrapperClass $class Wrapper class
+     * @return WrapperClass Class declaring a private static $ffi property
      */
-    public function generateCodeFiles(GeneratedCode $generatedCode, ProjectConfig $config): array
+    private function withCachedFFI(WrapperClass $class): WrapperClass
     {
-        $files = [];
+        $property = '    private static ?FFI $ffi = null;';
 
-        foreach ($generatedCode->classes as $class) {
-            $filename = $this->getClassFilename($class);
-            
-            // Determine the type of class and generate appropriate code
-            if ($class->name === 'Bootstrap') {
-                // Special handling for Bootstrap class
-                $content = $this->generateBootstrapClassCode($class);
-            } elseif (str_contains($class->namespace, 'Struct')) {
-                // This is a struct class - we need the original structure definition
-                // For now, use the legacy method
-                $content = $this->generateStructClassContent($class);
-            } elseif (str_contains($class->namespace, 'Constants')) {
-                $content = $this->constantGenerator->generateConstantsClassCode($class);
-            } else {
-                $content = $this->classGenerator->generateClassCode($class, $config->getLibraryFile());
-            }
-            
-            $files[$filename] = $content;
+        if (in_array($property, $class->properties, true)) {
+            return $class;
         }
 
-        return $files;
+        return new WrapperClass(
+            $class->name,
+            $class->namespace,
+            $class->methods,
+            array_merge([$property], $class->properties),
+            $class->constants
+        );
     }
 
     /**
@@ -400,7 +1217,11 @@ class WrapperGenerator implements GeneratorInterface
         $code .= "/**\n";
         $code .= " * Generated wrapper class for C struct {$class->name}\n";
         $code .= " */\n";
-        $code .= "class {$class->name}\n";
+        $code .= "class {$class->name}";
+        if (!empty($class->interfaces)) {
+            $code .= ' implements \\' . implode(', \\', $class->interfaces);
+        }
+        $code .= "\n";
         $code .= "{\n";
 
         // Add properties
@@ -425,12 +1246,21 @@ class WrapperGenerator implements GeneratorInterface
      *
      * @param ProjectConfig $config Project configuration
      * @param string $namespace Base namespace
+     * @param string $declarations C declarations for FFI::cdef()
+     * @param array<string, \Yangweijie\CWrapper\Analyzer\FunctionSignature> $batchFunctions Functions exported by the batch shim
+     * @param array<string> $functionNames Wrapped C functions, their index is the shared statistics slot
      * @return WrapperClass Bootstrap class
      */
-    private function generateBootstrapClass(ProjectConfig $config, string $namespace): WrapperClass
-    {
+    private function generateBootstrapClass(
+        ProjectConfig $config,
+        string $namespace,
+        string $declarations,
+        array $batchFunctions = [],
+        array $functionNames = []
+    ): WrapperClass {
         $className = 'Bootstrap';
         $libraryPath = $config->getLibraryFile();
+        $generationConfig = $config->getGenerationConfig();
         
         // Create properties
         $properties = [
@@ -438,12 +1268,47 @@ class WrapperGenerator implements GeneratorInterface
             'public const LIBRARY_PATH = \'' . addslashes($libraryPath) . '\';'
         ];
 
+        if ($generationConfig->isPreloadEnabled()) {
+            $properties[] = 'public const FFI_SCOPE = ' . var_export($this->getScopeName($namespace), true) . ';';
+            $properties[] = 'public const SCOPE_HEADER = __DIR__ . \'/' . self::SCOPE_HEADER . '\';';
+            $initializeMethod = $this->generateScopeInitializeMethod();
+        } elseif ($generationConfig->getDeclarationStorage() === 'file') {
+            $properties[] = 'public const DECLARATIONS_FILE = __DIR__ . \'/' . self::DECLARATIONS_FILE . '\';';
+            $initializeMethod = $this->generateInitializeMethod('require self::DECLARATIONS_FILE');
+        } else {
+            $properties[] = 'public const CDEF = ' . var_export($declarations, true) . ';';
+            $initializeMethod = $this->generateInitializeMethod('self::CDEF');
+        }
+
         // Create methods
         $methods = [
             $this->generateGetFFIMethod(),
-            $this->generateInitializeMethod()
+            $initializeMethod
         ];
 
+        if (!empty($batchFunctions)) {
+            $properties[] = 'private static ?\\FFI $batchFfi = null;';
+            $properties[] = 'public const BATCH_LIBRARY_PATH = __DIR__ . \'/' . basename($config->getBatchLibraryFile()) . '\';';
+            $properties[] = 'public const BATCH_CDEF = '
+                . var_export($this->batchShimGenerator->generateDeclarations($batchFunctions), true) . ';';
+            $methods[] = $this->generateGetBatchFFIMethod();
+        }
+
+        if ($generationConfig->isInstrumentEnabled()) {
+            $properties[] = 'public const PROFILE_BUFFER_SIZE = ' . self::PROFILE_BUFFER_SIZE . ';';
+            $properties[] = 'private static array $profileTotals = [];';
+            $properties[] = 'private static array $profileSamples = [];';
+            $properties[] = 'private static int $profileCursor = 0;';
+            $methods[] = $this->generateProfilerMethods($generationConfig->isSharedStatsEnabled());
+        }
+
+        if ($generationConfig->isSharedStatsEnabled()) {
+            $properties[] = 'public const STATS_SHM_KEY = ' . SharedStatsSegment::keyFor($namespace) . ';';
+            $properties[] = 'public const STATS_FUNCTIONS = ' . $this->exportFunctionIds($functionNames) . ';';
+            $properties[] = 'private static \\Shmop|false|null $statsSegment = null;';
+            $methods[] = $this->generateSharedStatsMethods();
+        }
+
         return new WrapperClass(
             $className,
             $namespace,
@@ -475,17 +1340,245 @@ class WrapperGenerator implements GeneratorInterface
     }';
     }
 
+    /**
+     * Generate getBatchFFI method for Bootstrap class
+     *
+     * @return string Method code
+     */
+    private function generateGetBatchFFIMethod(): string
+    {
+        return '    /**
+     * Get FFI instance of the compiled batch shim
+     *
+     * @return \\FFI Batch shim FFI instance
+     */
+    public static function getBatchFFI(): \\FFI
+    {
+        return self::$batchFfi ??= \\FFI::cdef(self::BATCH_CDEF, self::BATCH_LIBRARY_PATH);
+    }';
+    }
+
+    /**
+     * Generate the profiler methods of an instrumented Bootstrap class
+     *
+     * Instrumented wrappers report every call to recordCall(). Totals are kept
+     * per C function and the latest calls in a fixed-size ring buffer, so the
+     * memory used does not grow with the request.
+     *
+     * @param bool $sharedStats Also aggregate every call into the shared memory segment
+     * @return string Method code
+     */
+    private function generateProfilerMethods(bool $sharedStats = false): string
+    {
+        $sharedRecord = $sharedStats ? "\n        self::recordSharedCall(\$function, \$elapsedNs);" : '';
+
+        return '    /**
+     * Record one instrumented wrapper call
+     *
+     * @param string $function C function name
+     * @param int $elapsedNs Wall time of the wrapper call in nanoseconds
+     * @param int $marshalNs Part spent validating and converting arguments before the FFI call
+     */
+    public static function recordCall(string $function, int $elapsedNs, int $marshalNs): void
+    {
+        $totals = &self::$profileTotals[$function];
+        $totals ??= [\'calls\' => 0, \'elapsedNs\' => 0, \'marshalNs\' => 0];
+        $totals[\'calls\']++;
+        $totals[\'elapsedNs\'] += $elapsedNs;
+        $totals[\'marshalNs\'] += $marshalNs;
+
+        self::$profileSamples[self::$profileCursor++ % self::PROFILE_BUFFER_SIZE] = [$function, $elapsedNs, $marshalNs];' . $sharedRecord . '
+    }
+
+    /**
+     * Get the recorded profile
+     *
+     * @return array{functions: array<string, array{calls: int, elapsedNs: int, marshalNs: int}>, recent: array<array{function: string, elapsedNs: int, marshalNs: int}>}
+     */
+    public static function getProfile(): array
+    {
+        $functions = self::$profileTotals;
+        uasort($functions, fn($a, $b) => $b[\'elapsedNs\'] <=> $a[\'elapsedNs\']);
+
+        // Unroll the ring buffer from the oldest sample
+        $recent = [];
+        $count = min(self::$profileCursor, self::PROFILE_BUFFER_SIZE);
+        for ($i = self::$profileCursor - $count; $i < self::$profileCursor; $i++) {
+            [$function, $elapsedNs, $marshalNs] = self::$profileSamples[$i % self::PROFILE_BUFFER_SIZE];
+            $recent[] = [\'function\' => $function, \'elapsedNs\' => $elapsedNs, \'marshalNs\' => $marshalNs];
+        }
+
+        return [\'functions\' => $functions, \'recent\' => $recent];
+    }
+
+    /**
+     * Write the recorded profile as JSON
+     *
+     * @param string $file Target file, \'php://stdout\' or \'php://stderr\' work as well
+     * @throws \\RuntimeException If the file cannot be written
+     */
+    public static function dumpProfile(string $file): void
+    {
+        $json = json_encode(self::getProfile(), JSON_PRETTY_PRINT | JSON_THROW_ON_ERROR);
+
+        if (file_put_contents($file, $json . "\\n") === false) {
+            throw new \\RuntimeException(\'Failed to write profile to \' . $file);
+        }
+    }
+
+    /**
+     * Discard the recorded profile
+     */
+    public static function resetProfile(): void
+    {
+        self::$profileTotals = [];
+        self::$profileSamples = [];
+        self::$profileCursor = 0;
+    }';
+    }
+
+    /**
+     * Export the shared statistics slot of each function as a PHP array literal
+     *
+     * @param array<string> $functionNames Wrapped C functions
+     * @return string PHP code
+     */
+    private function exportFunctionIds(array $functionNames): string
+    {
+        $entries = [];
+        foreach (array_values(array_unique($functionNames)) as $id => $functionName) {
+            $entries[] = var_export($functionName, true) . ' => ' . $id;
+        }
+
+        return '[' . implode(', ', $entries) . ']';
+    }
+
+    /**
+     * Generate the methods aggregating calls into the shared statistics segment
+     *
+     * The segment layout is described by SharedStatsSegment, which the stats
+     * command uses to read it back. Each worker updates the slots of shard
+     * pid % SHARDS with plain read-modify-write cycles and no lock, so only
+     * workers sharing a shard can lose each other's increments.
+     *
+     * @return string Method code
+     */
+    private function generateSharedStatsMethods(): string
+    {
+        $headerSize = SharedStatsSegment::HEADER_SIZE;
+        $nameSize = SharedStatsSegment::NAME_SIZE;
+        $slotSize = SharedStatsSegment::SLOT_SIZE;
+        $buckets = SharedStatsSegment::BUCKETS;
+        $bucketBase = SharedStatsSegment::BUCKET_BASE_NS;
+        $magic = SharedStatsSegment::MAGIC;
+        $version = SharedStatsSegment::VERSION;
+        $shards = SharedStatsSegment::SHARDS;
+
+        return <<<PHP
+    /**
+     * Add one call to the statistics shared by all workers
+     *
+     * @param string \$function C function name
+     * @param int \$elapsedNs Wall time of the wrapper call in nanoseconds
+     */
+    private static function recordSharedCall(string \$function, int \$elapsedNs): void
+    {
+        \$id = self::STATS_FUNCTIONS[\$function] ?? null;
+        \$segment = self::\$statsSegment ??= self::openStatsSegment();
+
+        if (\$id === null || \$segment === false) {
+            return;
+        }
+
+        \$shard = \getmypid() % {$shards};
+        \$offset = {$headerSize} + (\$shard * count(self::STATS_FUNCTIONS) + \$id) * {$slotSize} + {$nameSize};
+        \$counters = unpack('Pcalls/PtotalNs/PmaxNs', shmop_read(\$segment, \$offset, 24));
+        shmop_write(\$segment, pack(
+            'PPP',
+            \$counters['calls'] + 1,
+            \$counters['totalNs'] + \$elapsedNs,
+            max(\$counters['maxNs'], \$elapsedNs)
+        ), \$offset);
+
+        \$bucket = 0;
+        for (\$limit = {$bucketBase}; \$elapsedNs >= \$limit && \$bucket < {$buckets} - 1; \$limit <<= 1) {
+            \$bucket++;
+        }
+
+        \$bucketOffset = \$offset + 24 + \$bucket * 8;
+        shmop_write(\$segment, pack('P', unpack('P', shmop_read(\$segment, \$bucketOffset, 8))[1] + 1), \$bucketOffset);
+    }
+
+    /**
+     * Attach to the shared statistics segment, creating it on first use
+     *
+     * Statistics are silently disabled without the shmop extension or when
+     * the existing segment was created for a different function list; remove
+     * it with deleteSharedStats() after regenerating the wrappers.
+     *
+     * @return \Shmop|false Segment, false if unavailable
+     */
+    private static function openStatsSegment(): \Shmop|false
+    {
+        if (!function_exists('shmop_open')) {
+            return false;
+        }
+
+        \$slots = count(self::STATS_FUNCTIONS);
+        \$segment = @shmop_open(self::STATS_SHM_KEY, 'c', 0644, {$headerSize} + {$shards} * \$slots * {$slotSize});
+
+        if (\$segment === false) {
+            return false;
+        }
+
+        \$header = unpack('a4magic/Vversion/Vslots/VslotSize/Vshards', shmop_read(\$segment, 0, {$headerSize}));
+
+        if (\$header['magic'] !== '{$magic}') {
+            // Write the slot names of the first shard before the header, readers skip segments without it
+            foreach (self::STATS_FUNCTIONS as \$function => \$id) {
+                shmop_write(\$segment, str_pad(substr(\$function, 0, {$nameSize} - 1), {$nameSize}, "\\0"), {$headerSize} + \$id * {$slotSize});
+            }
+
+            shmop_write(\$segment, pack('a4VVVV', '{$magic}', {$version}, \$slots, {$slotSize}, {$shards}), 0);
+        } elseif (\$header['version'] !== {$version} || \$header['slots'] !== \$slots
+            || \$header['slotSize'] !== {$slotSize} || \$header['shards'] !== {$shards}) {
+            return false;
+        }
+
+        return \$segment;
+    }
+
+    /**
+     * Remove the shared statistics segment, resetting the statistics of all workers
+     */
+    public static function deleteSharedStats(): void
+    {
+        \$segment = self::\$statsSegment ?: (function_exists('shmop_open') ? @shmop_open(self::STATS_SHM_KEY, 'w', 0, 0) : false);
+
+        if (\$segment !== false) {
+            shmop_delete(\$segment);
+        }
+
+        self::\$statsSegment = null;
+    }
+PHP;
+    }
+
     /**
      * Generate initialize method for Bootstrap class
      *
+     * @param string $declarationSource PHP expression yielding the embedded declarations
      * @return string Method code
      */
-    private function generateInitializeMethod(): string
+    private function generateInitializeMethod(string $declarationSource): string
     {
         return '    /**
      * Initialize FFI instance with library
      *
-     * @param string|null $headerFile Optional header file path
+     * Uses the declarations embedded at generation time, no header is read
+     * unless one is passed explicitly.
+     *
+     * @param string|null $headerFile Optional header file path overriding the embedded declarations
      * @throws \\RuntimeException If library cannot be loaded
      */
     public static function initialize(?string $headerFile = null): void
@@ -494,7 +1587,7 @@ class WrapperGenerator implements GeneratorInterface
             return; // Already initialized
         }
 
-        $headerContent = \'\';
+        $headerContent = ' . $declarationSource . ';
         if ($headerFile && file_exists($headerFile)) {
             $headerContent = file_get_contents($headerFile);
         }
@@ -511,6 +1604,113 @@ class WrapperGenerator implements GeneratorInterface
     }';
     }
 
+    /**
+     * Generate initialize method resolving a preloaded FFI scope
+     *
+     * @return string Method code
+     */
+    private function generateScopeInitializeMethod(): string
+    {
+        return '    /**
+     * Initialize FFI instance from the preloaded scope
+     *
+     * Falls back to loading the scope header in-process when the
+     * declarations were not preloaded (e.g. on the CLI).
+     *
+     * @param string|null $headerFile Optional scope header path
+     * @throws \\RuntimeException If library cannot be loaded
+     */
+    public static function initialize(?string $headerFile = null): void
+    {
+        if (self::$ffi !== null) {
+            return; // Already initialized
+        }
+
+        try {
+            self::$ffi = \\FFI::scope(self::FFI_SCOPE);
+            return;
+        } catch (\\Throwable $e) {
+            // Scope not preloaded, load it below
+        }
+
+        try {
+            $ffi = \\FFI::load($headerFile ?? self::SCOPE_HEADER);
+        } catch (\\Throwable $e) {
+            $ffi = null;
+        }
+
+        if ($ffi === null) {
+            throw new \\RuntimeException(
+                \'Failed to initialize FFI scope \' . self::FFI_SCOPE . \' with library: \' . self::LIBRARY_PATH
+            );
+        }
+
+        self::$ffi = $ffi;
+    }';
+    }
+
+    /**
+     * Generate the FFI scope header and opcache preload script
+     *
+     * @param ProjectConfig $config Project configuration
+     * @param array<string> $classNames Generated classes to precompile
+     * @param string $declarations C declarations for the scope
+     * @return array<string, string> Filename => content
+     */
+    private function generatePreloadFiles(ProjectConfig $config, array $classNames, string $declarations): array
+    {
+        $libraryPath = $config->getLibraryFile();
+        if ($libraryPath !== '' && file_exists($libraryPath)) {
+            $libraryPath = realpath($libraryPath) ?: $libraryPath;
+        }
+
+        $scopeHeader = $this->declarationBuilder->buildScopeHeader(
+            $declarations,
+            $this->getScopeName($config->getNamespace()),
+            $libraryPath
+        );
+
+        $script = "<?php\n\n";
+        $script .= "declare(strict_types=1);\n\n";
+        $script .= "/**\n";
+        $script .= " * Opcache preload script for {$config->getNamespace()}\n";
+        $script .= " *\n";
+        $script .= " * Parses the C declarations once at server start so every worker shares them.\n";
+        $script .= " * Enable it in php.ini:\n";
+        $script .= " *\n";
+        $script .= " *   opcache.preload={$config->getOutputPath()}/preload.php\n";
+        $script .= " *   ffi.enable=preload\n";
+        $script .= " */\n\n";
+        $script .= "if (\\FFI::load(__DIR__ . '/" . self::SCOPE_HEADER . "') === null) {\n";
+        $script .= "    throw new \\RuntimeException('Failed to preload FFI scope from ' . __DIR__ . '/" . self::SCOPE_HEADER . "');\n";
+        $script .= "}\n\n";
+        $script .= "if (function_exists('opcache_compile_file')) {\n";
+        $script .= "    foreach ([\n";
+        foreach ($classNames as $className) {
+            $script .= "        '" . $className . ".php',\n";
+        }
+        $script .= "    ] as \$file) {\n";
+        $script .= "        opcache_compile_file(__DIR__ . '/' . \$file);\n";
+        $script .= "    }\n";
+        $script .= "}\n";
+
+        return [
+            self::SCOPE_HEADER => $scopeHeader,
+            'preload.php' => $script,
+        ];
+    }
+
+    /**
+     * Convert a namespace to an FFI scope name
+     *
+     * @param string $namespace PHP namespace
+     * @return string Scope name safe for a C string literal
+     */
+    private function getScopeName(string $namespace): string
+    {
+        return preg_replace('/[^A-Za-z0-9_]/', '_', trim($namespace, '\\'));
+    }
+
     /**
      * Generate Bootstrap class code
      *
@@ -549,14 +1749,14 @@ class WrapperGenerator implements GeneratorInterface
     /**
      * Generate comprehensive documentation
      *
-     * @param GeneratedCode $generatedCode Generated code
+     * @param array<WrapperClass> $classes Generated classes
      * @param ProjectConfig|null $config Project configuration
      * @return Documentation Generated documentation
      */
-    private function generateDocumentation(GeneratedCode $generatedCode, ?ProjectConfig $config = null): Documentation
+    private function generateDocumentation(array $classes, ?ProjectConfig $config = null): Documentation
     {
-        $readmeContent = $this->generateReadmeContent($generatedCode, $config);
-        $examples = $this->generateUsageExamples($generatedCode, $config);
+        $readmeContent = $this->generateReadmeContent($classes, $config);
+        $examples = $this->generateUsageExamples($classes, $config);
         
         return new Documentation(
             [], // PHPDoc comments are already in the generated classes
@@ -568,11 +1768,11 @@ class WrapperGenerator implements GeneratorInterface
     /**
      * Generate README content
      *
-     * @param GeneratedCode $generatedCode Generated code
+     * @param array<WrapperClass> $classes Generated classes
      * @param ProjectConfig|null $config Project configuration
      * @return string README content
      */
-    private function generateReadmeContent(GeneratedCode $generatedCode, ?ProjectConfig $config = null): string
+    private function generateReadmeContent(array $classes, ?ProjectConfig $config = null): string
     {
         $namespace = $config ? $config->getNamespace() : 'Generated\\Wrapper';
         $libraryPath = $config ? $config->getLibraryFile() : 'path/to/your/library';
@@ -616,7 +1816,7 @@ class WrapperGenerator implements GeneratorInterface
         $content .= "## Generated Classes\n\n";
         $content .= "The following wrapper classes have been generated:\n\n";
         
-        foreach ($generatedCode->classes as $class) {
+        foreach ($classes as $class) {
             if ($class->name === 'Bootstrap') {
                 $content .= "### {$class->name}\n";
                 $content .= "Centralized FFI management class. Use this to initialize the library.\n\n";
@@ -633,7 +1833,7 @@ class WrapperGenerator implements GeneratorInterface
         // Examples section
         $content .= "## Examples\n\n";
         $generationType = $config ? $config->getGenerationType() : 'object';
-        $content .= $this->generateExampleUsage($generatedCode, $namespace, $generationType);
+        $content .= $this->generateExampleUsage($classes, $namespace, $generationType);
         
         // Notes section
         $content .= "## Important Notes\n\n";
@@ -657,17 +1857,17 @@ class WrapperGenerator implements GeneratorInterface
     /**
      * Generate usage examples
      *
-     * @param GeneratedCode $generatedCode Generated code
+     * @param array<WrapperClass> $classes Generated classes
      * @param ProjectConfig|null $config Project configuration
      * @return array<string> Usage examples
      */
-    private function generateUsageExamples(GeneratedCode $generatedCode, ?ProjectConfig $config = null): array
+    private function generateUsageExamples(array $classes, ?ProjectConfig $config = null): array
     {
         $examples = [];
         $namespace = $config ? $config->getNamespace() : 'Generated\\Wrapper';
         
         // Find UI-related classes for examples
-        $uiClasses = array_filter($generatedCode->classes, fn($class) => str_starts_with($class->name, 'Ui') && $class->name !== 'Ui');
+        $uiClasses = array_filter($classes, fn($class) => str_starts_with($class->name, 'Ui') && $class->name !== 'Ui');
         
         if (!empty($uiClasses)) {
             $examples[] = $this->generateUIExample($uiClasses, $namespace);
@@ -679,24 +1879,24 @@ class WrapperGenerator implements GeneratorInterface
     /**
      * Generate example usage code
      *
-     * @param GeneratedCode $generatedCode Generated code
+     * @param array<WrapperClass> $classes Generated classes
      * @param string $namespace Namespace
      * @param string $generationType Generation type
      * @return string Example code
      */
-    private function generateExampleUsage(GeneratedCode $generatedCode, string $namespace, string $generationType = 'object'): string
+    private function generateExampleUsage(array $classes, string $namespace, string $generationType = 'object'): string
     {
         if ($generationType === 'functional') {
-            return $this->generateFunctionalExample($generatedCode, $namespace);
+            return $this->generateFunctionalExample($classes, $namespace);
         } else {
-            return $this->generateObjectExample($generatedCode, $namespace);
+            return $this->generateObjectExample($classes, $namespace);
         }
     }
 
     /**
      * Generate object-oriented example
      */
-    private function generateObjectExample(GeneratedCode $generatedCode, string $namespace): string
+    private function generateObjectExample(array $classes, string $namespace): string
     {
         $example = "### Object-Oriented Example\n\n";
         $example .= "```php\n";
@@ -705,7 +1905,7 @@ class WrapperGenerator implements GeneratorInterface
         $example .= "use {$namespace}\\Bootstrap;\n";
         
         // Find some example classes
-        $uiClasses = array_filter($generatedCode->classes, fn($class) => str_starts_with($class->name, 'Ui') && $class->name !== 'Ui');
+        $uiClasses = array_filter($classes, fn($class) => str_starts_with($class->name, 'Ui') && $class->name !== 'Ui');
         
         if (!empty($uiClasses)) {
             $firstClass = reset($uiClasses);
@@ -748,7 +1948,7 @@ class WrapperGenerator implements GeneratorInterface
     /**
      * Generate functional/procedural example
      */
-    private function generateFunctionalExample(GeneratedCode $generatedCode, string $namespace): string
+    private function generateFunctionalExample(array $classes, string $namespace): string
     {
         $example = "### Functional/Procedural Example\n\n";
         $example .= "```php\n";
@@ -809,16 +2009,34 @@ class WrapperGenerator implements GeneratorInterface
      *
      * @param array<\Yangweijie\CWrapper\Analyzer\FunctionSignature> $functions Functions to wrap
      * @param string $namespace Namespace
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
      * @return WrapperClass Functional wrapper class
      */
-    private function generateFunctionalWrapper(array $functions, string $namespace): WrapperClass
-    {
+    private function generateFunctionalWrapper(
+        array $functions,
+        string $namespace,
+        bool $directDispatch = false,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $outParams = false,
+        bool $instrument = false
+    ): WrapperClass {
         $className = 'Functions';
         $methods = [];
         
         // Generate all functions as static methods in a single class
         foreach ($functions as $function) {
-            $methods[] = $this->methodGenerator->generateMethod($function, 'functional', $className);
+            $methods[] = $this->methodGenerator->generateMethod(
+                $function,
+                'functional',
+                $className,
+                $directDispatch,
+                $profile,
+                $outParams,
+                $instrument
+            );
         }
         
         return new WrapperClass(
@@ -830,33 +2048,75 @@ class WrapperGenerator implements GeneratorInterface
         );
     }
 
+    /**
+     * Record the C type of each klitsche/ffigen parameter from the analyzed signatures
+     *
+     * @param array<string, array> $functions Function info from klitsche/ffigen
+     * @param array<\Yangweijie\CWrapper\Analyzer\FunctionSignature> $signatures Analyzed C signatures
+     * @return array<string, array> Function info with 'cType' set on known parameters
+     */
+    private function attachParameterCTypes(array $functions, array $signatures): array
+    {
+        foreach ($signatures as $signature) {
+            if (!isset($functions[$signature->name])) {
+                continue;
+            }
+
+            $cTypes = array_column($signature->parameters, 'type', 'name');
+
+            foreach ($functions[$signature->name]['parameters'] as $index => $param) {
+                if (isset($cTypes[$param['name']])) {
+                    $functions[$signature->name]['parameters'][$index]['cType'] = $cTypes[$param['name']];
+                }
+            }
+        }
+
+        return $functions;
+    }
+
     /**
      * Generate improved classes based on klitsche/ffigen output
      *
-     * @param string $methodsFilePath Path to Methods.php file
+     * @param array<string, array> $functions Functions of the ffigen trait from the binding IR, keyed by name
      * @param string $baseNamespace Base namespace
      * @param string $generationType Generation type
-     * @return array<WrapperClass> Generated wrapper classes
+     * @param array<array{kind: string, name: string, code: string}>|null $scopeDeclarations Declarations to slice per class, null for a shared scope
+     * @param bool $directDispatch Call through the cached class-level FFI handle
+     * @param string $profile Generation profile: 'debug' or 'release'
+     * @param bool $outParams Return scalar out-pointer values instead of taking CData arguments
+     * @param bool $instrument Record call counts and timings in the Bootstrap profiler
+     * @param array<\Yangweijie\CWrapper\Analyzer\FunctionSignature> $signatures Analyzed C signatures, source of the parameter C types
+     * @param array<string, \Yangweijie\CWrapper\Analyzer\FunctionSignature> $batchFunctions Functions that also get a batch method
+     * @param array<string, int>|null $only Group names to generate as keys, null for all
+     * @return \Generator<string, WrapperClass> Generated wrapper classes keyed by function group
      */
-    private function generateImprovedClasses(string $methodsFilePath, string $baseNamespace, string $generationType): array
-    {
+    private function generateImprovedClasses(
+        array $functions,
+        string $baseNamespace,
+        string $generationType,
+        ?array $scopeDeclarations = null,
+        bool $directDispatch = false,
+        string $profile = GenerationConfig::PROFILE_DEBUG,
+        bool $outParams = false,
+        bool $instrument = false,
+        array $signatures = [],
+        array $batchFunctions = [],
+        ?array $only = null
+    ): \Generator {
         $parser = new FFIGenOutputParser();
         $improvedGenerator = new ImprovedMethodGenerator($parser);
-        
-        // Parse klitsche/ffigen output
-        $functions = $parser->parseMethodsFile($methodsFilePath);
-        
-        if (empty($functions)) {
-            return [];
-        }
 
-        $classes = [];
+        $functions = $this->attachParameterCTypes($functions, $signatures);
 
         if ($generationType === 'object') {
             // Group functions semantically
             $functionGroups = $parser->groupFunctionsBySemantics($functions);
             
             foreach ($functionGroups as $groupName => $functionNames) {
+                if ($only !== null && !isset($only[$groupName])) {
+                    continue;
+                }
+
                 $className = $this->convertGroupNameToClassName($groupName);
                 $methods = [];
                 
@@ -866,22 +2126,34 @@ class WrapperGenerator implements GeneratorInterface
                             $functionName,
                             $functions[$functionName],
                             $className,
-                            $generationType
+                            $generationType,
+                            $directDispatch,
+                            $profile,
+                            $outParams,
+                            $instrument
                         );
                     }
                 }
                 
                 if (!empty($methods)) {
-                    $classes[] = new WrapperClass(
+                    $wrapperClass = new WrapperClass(
                         $className,
                         $baseNamespace,
                         $methods,
                         [], // No properties
                         []  // No constants
                     );
+
+                    if ($scopeDeclarations !== null) {
+                        $wrapperClass = $this->withScopeDeclarations($wrapperClass, $scopeDeclarations, $functionNames);
+                    }
+
+                    $wrapperClass = $this->withBatchMethods($wrapperClass, $functionNames, $batchFunctions, $generationType);
+
+                    yield $groupName => $directDispatch ? $this->withCachedFFI($wrapperClass) : $wrapperClass;
                 }
             }
-        } else {
+        } elseif ($only === null || isset($only['Functions'])) {
             // Generate functional wrapper
             $methods = [];
             
@@ -890,21 +2162,24 @@ class WrapperGenerator implements GeneratorInterface
                     $functionName,
                     $functionInfo,
                     'Functions',
-                    $generationType
+                    $generationType,
+                    $directDispatch,
+                    $profile,
+                    $outParams,
+                    $instrument
                 );
             }
             
             if (!empty($methods)) {
-                $classes[] = new WrapperClass(
-                    'Functions',
-                    $baseNamespace,
-                    $methods,
-                    [],
-                    []
+                $wrapperClass = $this->withBatchMethods(
+                    new WrapperClass('Functions', $baseNamespace, $methods, [], []),
+                    array_keys($batchFunctions),
+                    $batchFunctions,
+                    $generationType
                 );
+
+                yield 'Functions' => $directDispatch ? $this->withCachedFFI($wrapperClass) : $wrapperClass;
             }
         }
-
-        return $classes;
     }
 }
\ No newline at end of file
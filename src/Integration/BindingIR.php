@@ -0,0 +1,129 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+use Yangweijie\CWrapper\Analyzer\FunctionSignature;
+use Yangweijie\CWrapper\Analyzer\StructureDefinition;
+use Yangweijie\CWrapper\Generator\FFIGenOutputParser;
+
+/**
+ * Structured form of the klitsche/ffigen output
+ *
+ * Built from Methods.php and constants.php in one pass and shared by every
+ * later stage, so the generated trait is never parsed again. Cached next to
+ * the bindings as JSON, keyed by the hash of the files it was built from.
+ */
+class BindingIR
+{
+    public const CACHE_FILENAME = '.ffi-bindings.json';
+
+    /**
+     * Cache layout version, bump when the IR changes shape
+     */
+    private const FORMAT = 1;
+
+    /**
+     * @param array<string, array{name: string, returnType: string, parameters: array, docComment: array, documentation: array<string>, rawMethod: string}> $functions Functions keyed by name
+     * @param array<string> $structures Struct names
+     * @param array<string, mixed> $constants Constant values keyed by name
+     */
+    public function __construct(
+        public readonly array $functions,
+        public readonly array $structures,
+        public readonly array $constants
+    ) {
+    }
+
+    /**
+     * Build the IR from the ffigen output
+     *
+     * @param string $methodsContent Methods.php content
+     * @param array<string, mixed> $constants Constants parsed from constants.php
+     * @param FFIGenOutputParser|null $parser Parser of the generated trait
+     * @return self Binding IR
+     */
+    public static function fromMethods(string $methodsContent, array $constants, ?FFIGenOutputParser $parser = null): self
+    {
+        $bindings = ($parser ?? new FFIGenOutputParser())->parseBindings($methodsContent);
+
+        return new self($bindings['functions'], $bindings['structures'], $constants);
+    }
+
+    /**
+     * Load a cached IR
+     *
+     * @param string $cacheFile Cache file
+     * @param string $sourceHash Hash of the ffigen output the IR must be built from
+     * @return self|null Cached IR, null if missing, stale or unreadable
+     */
+    public static function load(string $cacheFile, string $sourceHash): ?self
+    {
+        if (!is_file($cacheFile)) {
+            return null;
+        }
+
+        $data = json_decode((string) file_get_contents($cacheFile), true);
+
+        if (!is_array($data) || ($data['format'] ?? null) !== self::FORMAT || ($data['source'] ?? null) !== $sourceHash) {
+            return null;
+        }
+
+        return new self($data['functions'] ?? [], $data['structures'] ?? [], $data['constants'] ?? []);
+    }
+
+    /**
+     * Encode the IR for the cache
+     *
+     * @param string $sourceHash Hash of the ffigen output the IR was built from
+     * @return string JSON document
+     */
+    public function toJson(string $sourceHash): string
+    {
+        return json_encode([
+            'format' => self::FORMAT,
+            'source' => $sourceHash,
+            'functions' => $this->functions,
+            'structures' => $this->structures,
+            'constants' => $this->constants,
+        ], JSON_UNESCAPED_SLASHES | JSON_PRESERVE_ZERO_FRACTION | JSON_THROW_ON_ERROR) . "\n";
+    }
+
+    /**
+     * Get the functions as signatures
+     *
+     * @return array<FunctionSignature> Function signatures
+     */
+    public function getFunctionSignatures(): array
+    {
+        $signatures = [];
+
+        foreach ($this->functions as $function) {
+            $signatures[] = new FunctionSignature(
+                $function['name'],
+                $function['returnType'],
+                array_map(fn($param) => [
+                    'name' => $param['name'],
+                    'type' => ($param['nullable'] ? '?' : '') . $param['type'],
+                ], $function['parameters']),
+                $function['documentation']
+            );
+        }
+
+        return $signatures;
+    }
+
+    /**
+     * Get the struct definitions
+     *
+     * ffigen does not describe struct fields, only their names are known here;
+     * WrapperGenerator fills in the fields parsed from the headers.
+     *
+     * @return array<StructureDefinition> Structure definitions
+     */
+    public function getStructureDefinitions(): array
+    {
+        return array_map(fn($name) => new StructureDefinition($name, []), $this->structures);
+    }
+}
\ No newline at end of file
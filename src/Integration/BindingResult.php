@@ -14,12 +14,35 @@ class BindingResult
      * @param string $methodsFile Path to generated Methods.php file
      * @param bool $success Whether generation was successful
      * @param array<string> $errors Any errors that occurred
+     * @param array<string, string> $outputs Generated file contents keyed by file name, when ffigen ran in process and nothing was written yet
      */
     public function __construct(
         public readonly string $constantsFile,
         public readonly string $methodsFile,
         public readonly bool $success,
-        public readonly array $errors = []
+        public readonly array $errors = [],
+        public readonly array $outputs = []
     ) {
     }
+
+    /**
+     * Get the content of a generated file, from memory or from disk
+     *
+     * @param string $path Path of the generated file
+     * @return string|null File content, null if it was neither returned nor written
+     */
+    public function getContent(string $path): ?string
+    {
+        if (isset($this->outputs[basename($path)])) {
+            return $this->outputs[basename($path)];
+        }
+
+        if (!is_file($path)) {
+            return null;
+        }
+
+        $content = file_get_contents($path);
+
+        return $content === false ? null : $content;
+    }
 }
\ No newline at end of file
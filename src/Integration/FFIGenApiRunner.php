@@ -0,0 +1,95 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+use Klitsche\FFIGen\Config as FFIGenConfig;
+use Yangweijie\CWrapper\Config\ConfigInterface;
+use Yangweijie\CWrapper\Exception\GenerationException;
+
+/**
+ * Runs klitsche/ffigen through its PHP API in the current process
+ *
+ * Follows the steps of ffigen's own generate command: the configuration
+ * array from FFIGenConfigurationBuilder becomes an ffigen Config, the
+ * configured parser reads the headers and the configured generator prints
+ * the bindings. The output path is an in-memory directory, so no process is
+ * spawned, no YAML file is written and the generated files are returned as
+ * data in the BindingResult.
+ */
+class FFIGenApiRunner
+{
+    private FFIGenConfigurationBuilder $configBuilder;
+
+    public function __construct(?FFIGenConfigurationBuilder $configBuilder = null)
+    {
+        $this->configBuilder = $configBuilder ?? new FFIGenConfigurationBuilder();
+    }
+
+    /**
+     * Check whether the installed ffigen exposes the API used here
+     *
+     * @return bool True if ffigen can run in process
+     */
+    public function isAvailable(): bool
+    {
+        return class_exists(FFIGenConfig::class)
+            && method_exists(FFIGenConfig::class, 'getParserClass')
+            && method_exists(FFIGenConfig::class, 'getGeneratorClass');
+    }
+
+    /**
+     * Generate bindings in process
+     *
+     * @param ConfigInterface $config Project configuration
+     * @return BindingResult Result holding the generated files in memory
+     * @throws GenerationException If ffigen is not available or the configuration is invalid
+     */
+    public function run(ConfigInterface $config): BindingResult
+    {
+        if (!$this->isAvailable()) {
+            throw new GenerationException('klitsche/ffigen is not installed or does not expose its PHP API');
+        }
+
+        try {
+            $ffiGenConfig = $this->configBuilder->buildConfiguration($config);
+        } catch (\Exception $e) {
+            throw new GenerationException('Failed to build ffigen configuration: ' . $e->getMessage(), 0, $e);
+        }
+
+        $outputPath = rtrim($config->getOutputPath(), '/\\');
+        $memoryPath = MemoryStreamWrapper::createDirectory();
+        $ffiGenConfig['outputPath'] = $memoryPath;
+
+        try {
+            $ffiGen = new FFIGenConfig($ffiGenConfig);
+
+            $parserClass = $ffiGen->getParserClass();
+            $parser = new $parserClass($ffiGen);
+            $types = $parser->parse();
+
+            $generatorClass = $ffiGen->getGeneratorClass();
+            $generator = new $generatorClass($ffiGen);
+            $generator->generate($types);
+        } catch (\Throwable $e) {
+            MemoryStreamWrapper::release($memoryPath);
+
+            return new BindingResult('', '', false, ['FFIGen error: ' . $e->getMessage()]);
+        }
+
+        $outputs = MemoryStreamWrapper::release($memoryPath);
+
+        if (!isset($outputs['constants.php'], $outputs['Methods.php'])) {
+            return new BindingResult(
+                $outputPath . '/constants.php',
+                $outputPath . '/Methods.php',
+                false,
+                ['Generated files not found'],
+                $outputs
+            );
+        }
+
+        return new BindingResult($outputPath . '/constants.php', $outputPath . '/Methods.php', true, [], $outputs);
+    }
+}
\ No newline at end of file
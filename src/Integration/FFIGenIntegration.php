@@ -5,6 +5,7 @@ declare(strict_types=1);
 namespace Yangweijie\CWrapper\Integration;
 
 use Yangweijie\CWrapper\Config\ConfigInterface;
+use Yangweijie\CWrapper\Config\ProjectConfig;
 
 /**
  * Main FFIGen integration implementation
@@ -30,7 +31,9 @@ class FFIGenIntegration implements FFIGenIntegrationInterface
      */
     public function generateBindings(ConfigInterface $config): BindingResult
     {
-        return $this->runner->run($config);
+        $jobs = $config instanceof ProjectConfig ? $config->getGenerationConfig()->getJobs() : 1;
+
+        return $this->runner->run($config, $jobs);
     }
 
     /**
@@ -0,0 +1,167 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+use Yangweijie\CWrapper\Exception\GenerationException;
+use Yangweijie\CWrapper\Generator\OutputWriter;
+
+/**
+ * Merges the outputs of several klitsche/ffigen runs into one set of files
+ *
+ * Used after sharded runs: constants and methods are concatenated in shard
+ * order with their doc comments, a symbol declared by several shards is kept
+ * once. Files are written through OutputWriter, so unchanged outputs keep
+ * their mtime and a crash never leaves a partial file behind.
+ */
+class FFIGenOutputMerger
+{
+    private OutputWriter $writer;
+
+    public function __construct(?OutputWriter $writer = null)
+    {
+        $this->writer = $writer ?? new OutputWriter();
+    }
+
+    /**
+     * Merge the ffigen outputs of several directories
+     *
+     * @param array<string> $sourceDirs Shard output directories
+     * @param string $outputPath Directory receiving constants.php, Methods.php and any other file
+     * @throws GenerationException If a merged file cannot be written
+     */
+    public function merge(array $sourceDirs, string $outputPath): void
+    {
+        $this->write($outputPath . '/constants.php', $this->mergeConstants(
+            array_map(fn($dir) => $dir . '/constants.php', $sourceDirs)
+        ));
+        $this->write($outputPath . '/Methods.php', $this->mergeMethods(
+            array_map(fn($dir) => $dir . '/Methods.php', $sourceDirs)
+        ));
+
+        // Any other file is copied from the first shard producing it
+        $copied = ['constants.php' => true, 'Methods.php' => true];
+        foreach ($sourceDirs as $dir) {
+            foreach (scandir($dir) ?: [] as $filename) {
+                if (isset($copied[$filename]) || !is_file($dir . '/' . $filename)) {
+                    continue;
+                }
+
+                $copied[$filename] = true;
+                $content = file_get_contents($dir . '/' . $filename);
+                if ($content === false) {
+                    throw new GenerationException("Failed to copy ffigen output: {$filename}");
+                }
+
+                $this->writer->write($outputPath . '/' . $filename, $content);
+            }
+        }
+    }
+
+    /**
+     * Merge constants.php files
+     *
+     * @param array<string> $files constants.php files in shard order
+     * @return string Merged file content
+     */
+    public function mergeConstants(array $files): string
+    {
+        $merged = null;
+        $names = [];
+
+        foreach ($files as $file) {
+            if (!is_file($file)) {
+                continue;
+            }
+
+            $content = (string) file_get_contents($file);
+            preg_match_all(
+                '/^(?:[ \t]*\/\*\*(?:(?!\*\/).)*\*\/\s*)?[ \t]*const\s+(\w+)\s*=[^;]*;/ms',
+                $content,
+                $matches,
+                PREG_SET_ORDER
+            );
+
+            if ($merged === null) {
+                // The first file provides the namespace and preamble
+                $merged = rtrim($content) . "\n";
+                foreach ($matches as $match) {
+                    $names[$match[1]] = true;
+                }
+                continue;
+            }
+
+            foreach ($matches as $match) {
+                if (!isset($names[$match[1]])) {
+                    $names[$match[1]] = true;
+                    // Keep the doc comment of the constant, indented as in its shard
+                    $merged .= rtrim($match[0]) . "\n";
+                }
+            }
+        }
+
+        return $merged ?? "<?php\n";
+    }
+
+    /**
+     * Merge Methods.php trait files
+     *
+     * @param array<string> $files Methods.php files in shard order
+     * @return string Merged file content
+     */
+    public function mergeMethods(array $files): string
+    {
+        $preamble = null;
+        $methods = [];
+
+        foreach ($files as $file) {
+            if (!is_file($file)) {
+                continue;
+            }
+
+            $content = (string) file_get_contents($file);
+
+            if (!preg_match('/\b(?:trait|class)\s+\w+[^{]*\{/', $content, $declaration, PREG_OFFSET_CAPTURE)) {
+                continue;
+            }
+
+            $bodyStart = $declaration[0][1] + strlen($declaration[0][0]);
+            $body = substr($content, $bodyStart, (int) strrpos($content, '}') - $bodyStart);
+
+            preg_match_all(
+                '/[ \t]*(?:\/\*\*(?:(?!\*\/).)*\*\/\s*)?public\s+static\s+function\s+(\w+)\s*\(/s',
+                $body,
+                $matches,
+                PREG_OFFSET_CAPTURE
+            );
+
+            $offsets = array_column($matches[0], 1);
+            $preamble ??= substr($content, 0, $bodyStart) . substr($body, 0, $offsets[0] ?? strlen($body));
+
+            foreach ($offsets as $index => $offset) {
+                $name = $matches[1][$index][0];
+                $end = $offsets[$index + 1] ?? strlen($body);
+                $methods[$name] ??= rtrim(substr($body, $offset, $end - $offset));
+            }
+        }
+
+        if ($preamble === null) {
+            return "<?php\n";
+        }
+
+        return rtrim($preamble) . "\n" . implode("\n\n", $methods) . "\n}\n";
+    }
+
+    /**
+     * Write a merged file if its content changed
+     *
+     * @param string $path Target file
+     * @param string $content File content
+     * @throws GenerationException If the file cannot be written
+     */
+    private function write(string $path, string $content): void
+    {
+        $this->writer->write($path, $content);
+    }
+}
\ No newline at end of file
@@ -14,22 +14,60 @@ use Symfony\Component\Process\Exception\ProcessFailedException;
  */
 class FFIGenRunner
 {
+    /**
+     * Timeout of one ffigen process in seconds
+     */
+    private const TIMEOUT = 300;
+
+    /**
+     * Directory below the output path receiving the output of each shard
+     */
+    private const SHARD_DIR = '.ffigen-shards';
+
     private FFIGenConfigurationBuilder $configBuilder;
+    private HeaderSharder $headerSharder;
+    private FFIGenOutputMerger $outputMerger;
+    private FFIGenApiRunner $apiRunner;
 
-    public function __construct(?FFIGenConfigurationBuilder $configBuilder = null)
-    {
+    public function __construct(
+        ?FFIGenConfigurationBuilder $configBuilder = null,
+        ?HeaderSharder $headerSharder = null,
+        ?FFIGenOutputMerger $outputMerger = null,
+        ?FFIGenApiRunner $apiRunner = null
+    ) {
         $this->configBuilder = $configBuilder ?? new FFIGenConfigurationBuilder();
+        $this->headerSharder = $headerSharder ?? new HeaderSharder();
+        $this->outputMerger = $outputMerger ?? new FFIGenOutputMerger();
+        $this->apiRunner = $apiRunner ?? new FFIGenApiRunner($this->configBuilder);
     }
 
     /**
      * Execute klitsche/ffigen with the provided configuration
      *
+     * With more than one job, independent headers are split into shards run
+     * by concurrent ffigen processes and their outputs merged. Otherwise
+     * ffigen runs in process when its PHP API is available, and the result
+     * carries the generated files in memory instead of writing them.
+     *
      * @param ConfigInterface $config Project configuration
+     * @param int $jobs Maximum number of concurrent ffigen processes
      * @return BindingResult Result of FFIGen execution
      * @throws GenerationException If FFIGen execution fails
      */
-    public function run(ConfigInterface $config): BindingResult
+    public function run(ConfigInterface $config, int $jobs = 1): BindingResult
     {
+        if ($jobs > 1) {
+            $shards = $this->headerSharder->partition($config->getHeaderFiles(), $jobs);
+
+            if (count($shards) > 1) {
+                return $this->runShards($config, $shards, $jobs);
+            }
+        }
+
+        if ($this->apiRunner->isAvailable()) {
+            return $this->apiRunner->run($config);
+        }
+
         try {
             // Create temporary configuration file
             $configFile = $this->createTemporaryConfigFile($config);
@@ -150,7 +188,7 @@ class FFIGenRunner
         foreach ($possibleCommands as $command) {
             try {
                 $process = new Process($command);
-                $process->setTimeout(300); // 5 minutes timeout
+                $process->setTimeout(self::TIMEOUT);
                 $process->run();
                 
                 // Return the process regardless of success/failure
@@ -167,4 +205,124 @@ class FFIGenRunner
             'Could not execute klitsche/ffigen. Make sure it is installed via Composer. Last error: ' . $lastError
         );
     }
+
+    /**
+     * Run one ffigen process per shard, at most $jobs at a time, and merge the outputs
+     *
+     * @param ConfigInterface $config Project configuration
+     * @param array<array<string>> $shards Headers of each shard
+     * @param int $jobs Maximum number of concurrent ffigen processes
+     * @return BindingResult Result of the merged FFIGen execution
+     * @throws GenerationException If FFIGen execution fails
+     */
+    private function runShards(ConfigInterface $config, array $shards, int $jobs): BindingResult
+    {
+        $outputPath = $config->getOutputPath();
+        $shardRoot = $outputPath . '/' . self::SHARD_DIR;
+        $command = $this->resolveFFIGenCommand();
+        $pending = [];
+        $running = [];
+        $configFiles = [];
+        $errors = [];
+
+        try {
+            foreach ($shards as $index => $headers) {
+                $shardConfig = new FFIGenShardConfig($config, $headers, "{$shardRoot}/{$index}");
+                $this->ensureOutputDirectory($shardConfig->getOutputPath());
+                $configFiles[$index] = $this->createTemporaryConfigFile($shardConfig);
+                $pending[$index] = $headers;
+            }
+
+            while (!empty($pending) || !empty($running)) {
+                while (count($running) < $jobs && !empty($pending)) {
+                    $index = array_key_first($pending);
+                    unset($pending[$index]);
+
+                    $process = new Process([...$command, 'generate', '-c', $configFiles[$index]]);
+                    $process->setTimeout(self::TIMEOUT);
+                    $process->start();
+                    $running[$index] = $process;
+                }
+
+                foreach ($running as $index => $process) {
+                    $process->checkTimeout();
+
+                    if ($process->isRunning()) {
+                        continue;
+                    }
+
+                    unset($running[$index]);
+
+                    if (!$process->isSuccessful()) {
+                        $errors[] = sprintf(
+                            'Shard %d (%s) failed with exit code %d: %s',
+                            $index,
+                            implode(', ', array_map('basename', $shards[$index])),
+                            $process->getExitCode(),
+                            trim($process->getErrorOutput() ?: $process->getOutput())
+                        );
+                    }
+                }
+
+                usleep(10000);
+            }
+
+            if (!empty($errors)) {
+                return new BindingResult('', '', false, $errors);
+            }
+
+            $this->outputMerger->merge(
+                array_map(fn($index) => "{$shardRoot}/{$index}", array_keys($shards)),
+                $outputPath
+            );
+
+            return new BindingResult($outputPath . '/constants.php', $outputPath . '/Methods.php', true);
+        } catch (\Exception $e) {
+            foreach ($running as $process) {
+                $process->stop(0);
+            }
+
+            throw new GenerationException('Failed to execute klitsche/ffigen: ' . $e->getMessage(), 0, $e);
+        } finally {
+            foreach ($configFiles as $configFile) {
+                @unlink($configFile);
+            }
+
+            $this->removeShardOutputs($shardRoot);
+        }
+    }
+
+    /**
+     * Find the ffigen executable
+     *
+     * @return array<string> Command prefix
+     * @throws GenerationException If ffigen is not installed
+     */
+    private function resolveFFIGenCommand(): array
+    {
+        if (is_file('vendor/bin/ffigen') && is_executable('vendor/bin/ffigen')) {
+            return ['vendor/bin/ffigen'];
+        }
+
+        if (is_file('vendor/bin/ffigen')) {
+            return ['php', 'vendor/bin/ffigen'];
+        }
+
+        throw new GenerationException('Could not find klitsche/ffigen. Make sure it is installed via Composer.');
+    }
+
+    /**
+     * Remove the shard output directories
+     *
+     * @param string $shardRoot Directory holding one subdirectory per shard
+     */
+    private function removeShardOutputs(string $shardRoot): void
+    {
+        foreach (glob($shardRoot . '/*', GLOB_ONLYDIR) ?: [] as $dir) {
+            array_map('unlink', glob($dir . '/{,.}*[!.]*', GLOB_BRACE) ?: []);
+            @rmdir($dir);
+        }
+
+        @rmdir($shardRoot);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,63 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+use Yangweijie\CWrapper\Config\ConfigInterface;
+
+/**
+ * Configuration of one sharded klitsche/ffigen run
+ *
+ * Takes the library, namespace and rules of the project configuration and
+ * replaces the headers and the output directory.
+ */
+class FFIGenShardConfig implements ConfigInterface
+{
+    /**
+     * @param ConfigInterface $config Project configuration
+     * @param array<string> $headerFiles Headers of the shard
+     * @param string $outputPath Output directory of the shard
+     */
+    public function __construct(
+        private readonly ConfigInterface $config,
+        private readonly array $headerFiles,
+        private readonly string $outputPath
+    ) {
+    }
+
+    public function getHeaderFiles(): array
+    {
+        return $this->headerFiles;
+    }
+
+    public function getLibraryFile(): string
+    {
+        return $this->config->getLibraryFile();
+    }
+
+    public function getOutputPath(): string
+    {
+        return $this->outputPath;
+    }
+
+    public function getNamespace(): string
+    {
+        return $this->config->getNamespace();
+    }
+
+    public function getValidationRules(): array
+    {
+        return $this->config->getValidationRules();
+    }
+
+    /**
+     * Exclude patterns are read by FFIGenConfigurationBuilder
+     *
+     * @return array<string>
+     */
+    public function getExcludePatterns(): array
+    {
+        return method_exists($this->config, 'getExcludePatterns') ? $this->config->getExcludePatterns() : [];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+use Yangweijie\CWrapper\Analyzer\DependencyResolver;
+
+/**
+ * Partitions header files into shards klitsche/ffigen can process independently
+ *
+ * Headers that include each other, or share a project header, end up in the
+ * same shard so each ffigen run sees every declaration it depends on. System
+ * headers are shared by everything and do not join shards.
+ */
+class HeaderSharder
+{
+    private DependencyResolver $dependencyResolver;
+
+    public function __construct(?DependencyResolver $dependencyResolver = null)
+    {
+        $this->dependencyResolver = $dependencyResolver ?? new DependencyResolver();
+    }
+
+    /**
+     * Partition header files into at most $maxShards shards of similar size
+     *
+     * @param array<string> $headerFiles Header files to process
+     * @param int $maxShards Maximum number of shards
+     * @return array<array<string>> Shards, each listing its headers in compilation order
+     */
+    public function partition(array $headerFiles, int $maxShards): array
+    {
+        $headers = array_values(array_unique(array_filter(array_map('realpath', $headerFiles))));
+
+        // Leave missing headers to ffigen, which reports them
+        if ($maxShards < 2 || count($headers) < 2 || count($headers) !== count(array_unique($headerFiles))) {
+            return [$headerFiles];
+        }
+
+        $graph = $this->dependencyResolver->getDependencyGraph($headers);
+        $position = array_flip($this->dependencyResolver->createCompilationOrder($headers));
+
+        // Union headers connected through an include or a shared project header
+        $parent = array_combine($headers, $headers);
+        $owners = [];
+        $weights = [];
+
+        foreach ($graph as $header => $dependencies) {
+            $weights[$header] = (int) filesize($header);
+
+            foreach ($dependencies as $dependency) {
+                if ($this->dependencyResolver->isSystemHeader($dependency)) {
+                    continue;
+                }
+
+                if (isset($parent[$dependency])) {
+                    $this->union($parent, $dependency, $header);
+                }
+
+                if (isset($owners[$dependency])) {
+                    $this->union($parent, $owners[$dependency], $header);
+                } else {
+                    $owners[$dependency] = $header;
+                    $weights[$header] += (int) filesize($dependency);
+                }
+            }
+        }
+
+        $components = [];
+        $componentWeights = [];
+        foreach ($headers as $header) {
+            $root = $this->find($parent, $header);
+            $components[$root][] = $header;
+            $componentWeights[$root] = ($componentWeights[$root] ?? 0) + $weights[$header];
+        }
+
+        // Greedily place the heaviest components on the lightest shard
+        arsort($componentWeights);
+        $shardCount = min($maxShards, count($components));
+        $shards = array_fill(0, $shardCount, []);
+        $shardWeights = array_fill(0, $shardCount, 0);
+
+        foreach ($componentWeights as $root => $weight) {
+            $lightest = array_keys($shardWeights, min($shardWeights), true)[0];
+            $shards[$lightest] = array_merge($shards[$lightest], $components[$root]);
+            $shardWeights[$lightest] += $weight;
+        }
+
+        foreach ($shards as &$shard) {
+            usort($shard, fn($a, $b) => ($position[$a] ?? 0) <=> ($position[$b] ?? 0));
+        }
+        unset($shard);
+
+        return $shards;
+    }
+
+    /**
+     * Find the representative of a header's component
+     *
+     * @param array<string, string> $parent Union-find parent links
+     * @param string $header Header path
+     * @return string Component root
+     */
+    private function find(array &$parent, string $header): string
+    {
+        while ($parent[$header] !== $header) {
+            $parent[$header] = $parent[$parent[$header]];
+            $header = $parent[$header];
+        }
+
+        return $header;
+    }
+
+    /**
+     * Merge the components of two headers
+     *
+     * @param array<string, string> $parent Union-find parent links
+     * @param string $a Header path
+     * @param string $b Header path
+     */
+    private function union(array &$parent, string $a, string $b): void
+    {
+        $rootA = $this->find($parent, $a);
+        $rootB = $this->find($parent, $b);
+
+        if ($rootA !== $rootB) {
+            $parent[$rootB] = $rootA;
+        }
+    }
+}
\ No newline at end of file
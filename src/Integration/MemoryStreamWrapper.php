@@ -0,0 +1,293 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Integration;
+
+/**
+ * Stream wrapper keeping written files in memory
+ *
+ * Lets klitsche/ffigen, which writes its output with the PHP file functions,
+ * run in process without touching the disk: its output path is pointed at a
+ * ffigen-memory:// directory and the files are collected afterwards.
+ */
+class MemoryStreamWrapper
+{
+    public const PROTOCOL = 'ffigen-memory';
+
+    /**
+     * File contents keyed by URL
+     *
+     * @var array<string, string>
+     */
+    private static array $files = [];
+
+    /**
+     * Directories keyed by URL
+     *
+     * @var array<string, true>
+     */
+    private static array $directories = [];
+
+    /** @var resource|null */
+    public $context;
+
+    private string $url = '';
+    private int $position = 0;
+    private bool $writable = false;
+
+    /**
+     * Register the wrapper once per process
+     */
+    public static function register(): void
+    {
+        if (!in_array(self::PROTOCOL, stream_get_wrappers(), true)) {
+            stream_wrapper_register(self::PROTOCOL, self::class);
+        }
+    }
+
+    /**
+     * Create an empty in-memory directory
+     *
+     * @return string Directory URL
+     */
+    public static function createDirectory(): string
+    {
+        self::register();
+
+        $url = self::PROTOCOL . '://' . bin2hex(random_bytes(8));
+        self::$directories[$url] = true;
+
+        return $url;
+    }
+
+    /**
+     * Remove an in-memory directory and return the files written below it
+     *
+     * @param string $directory Directory URL
+     * @return array<string, string> File contents keyed by path relative to the directory
+     */
+    public static function release(string $directory): array
+    {
+        $prefix = rtrim($directory, '/') . '/';
+        $files = [];
+
+        foreach (self::$files as $url => $content) {
+            if (str_starts_with($url, $prefix)) {
+                $files[substr($url, strlen($prefix))] = $content;
+                unset(self::$files[$url]);
+            }
+        }
+
+        foreach (array_keys(self::$directories) as $url) {
+            if ($url === rtrim($directory, '/') || str_starts_with($url, $prefix)) {
+                unset(self::$directories[$url]);
+            }
+        }
+
+        ksort($files);
+
+        return $files;
+    }
+
+    public function stream_open(string $path, string $mode, int $options, ?string &$openedPath): bool
+    {
+        $this->url = self::normalize($path);
+        $this->writable = strpbrk($mode, 'waxc+') !== false;
+        $exists = isset(self::$files[$this->url]);
+
+        if ((str_contains($mode, 'r') && !str_contains($mode, '+') && !$exists)
+            || (str_contains($mode, 'x') && $exists)
+            || !isset(self::$directories[dirname($this->url)])) {
+            return false;
+        }
+
+        if (str_contains($mode, 'w') || !$exists) {
+            self::$files[$this->url] = '';
+        }
+
+        $this->position = str_contains($mode, 'a') ? strlen(self::$files[$this->url]) : 0;
+
+        return true;
+    }
+
+    public function stream_read(int $count): string
+    {
+        $chunk = substr(self::$files[$this->url], $this->position, $count);
+        $this->position += strlen($chunk);
+
+        return $chunk;
+    }
+
+    public function stream_write(string $data): int
+    {
+        if (!$this->writable) {
+            return 0;
+        }
+
+        $content = self::$files[$this->url];
+        self::$files[$this->url] = substr($content, 0, $this->position)
+            . $data
+            . substr($content, $this->position + strlen($data));
+        $this->position += strlen($data);
+
+        return strlen($data);
+    }
+
+    public function stream_eof(): bool
+    {
+        return $this->position >= strlen(self::$files[$this->url]);
+    }
+
+    public function stream_tell(): int
+    {
+        return $this->position;
+    }
+
+    public function stream_seek(int $offset, int $whence = SEEK_SET): bool
+    {
+        $length = strlen(self::$files[$this->url]);
+        $position = match ($whence) {
+            SEEK_CUR => $this->position + $offset,
+            SEEK_END => $length + $offset,
+            default => $offset,
+        };
+
+        if ($position < 0) {
+            return false;
+        }
+
+        $this->position = $position;
+
+        return true;
+    }
+
+    public function stream_truncate(int $size): bool
+    {
+        self::$files[$this->url] = str_pad(substr(self::$files[$this->url], 0, $size), $size, "\0");
+
+        return true;
+    }
+
+    public function stream_flush(): bool
+    {
+        return true;
+    }
+
+    public function stream_lock(int $operation): bool
+    {
+        return true;
+    }
+
+    public function stream_set_option(int $option, int $arg1, ?int $arg2): bool
+    {
+        return false;
+    }
+
+    /**
+     * @return array<int|string, int>
+     */
+    public function stream_stat(): array
+    {
+        return $this->stat(strlen(self::$files[$this->url]), false);
+    }
+
+    /**
+     * @return array<int|string, int>|false
+     */
+    public function url_stat(string $path, int $flags): array|false
+    {
+        $url = self::normalize($path);
+
+        if (isset(self::$files[$url])) {
+            return $this->stat(strlen(self::$files[$url]), false);
+        }
+
+        return isset(self::$directories[$url]) ? $this->stat(0, true) : false;
+    }
+
+    public function mkdir(string $path, int $mode, int $options): bool
+    {
+        $url = self::normalize($path);
+
+        if (isset(self::$directories[$url]) || isset(self::$files[$url])) {
+            return false;
+        }
+
+        if (!isset(self::$directories[dirname($url)]) && !($options & STREAM_MKDIR_RECURSIVE)) {
+            return false;
+        }
+
+        for ($dir = $url; !str_ends_with($dir, ':') && !isset(self::$directories[$dir]); $dir = dirname($dir)) {
+            self::$directories[$dir] = true;
+        }
+
+        return true;
+    }
+
+    public function unlink(string $path): bool
+    {
+        $url = self::normalize($path);
+
+        if (!isset(self::$files[$url])) {
+            return false;
+        }
+
+        unset(self::$files[$url]);
+
+        return true;
+    }
+
+    public function rename(string $from, string $to): bool
+    {
+        $from = self::normalize($from);
+        $to = self::normalize($to);
+
+        if (!isset(self::$files[$from]) || !isset(self::$directories[dirname($to)])) {
+            return false;
+        }
+
+        self::$files[$to] = self::$files[$from];
+        unset(self::$files[$from]);
+
+        return true;
+    }
+
+    /**
+     * Build a stat() result
+     *
+     * @return array<int|string, int>
+     */
+    private function stat(int $size, bool $directory): array
+    {
+        $stat = [
+            'dev' => 0, 'ino' => 0, 'mode' => $directory ? 0040777 : 0100666, 'nlink' => 1,
+            'uid' => 0, 'gid' => 0, 'rdev' => 0, 'size' => $size,
+            'atime' => 0, 'mtime' => 0, 'ctime' => 0, 'blksize' => -1, 'blocks' => -1,
+        ];
+
+        return array_merge(array_values($stat), $stat);
+    }
+
+    /**
+     * Normalize a URL so "dir//file" and "dir/./file" address the same entry
+     */
+    private static function normalize(string $path): string
+    {
+        [$scheme, $rest] = explode('://', $path, 2) + [1 => ''];
+        $segments = [];
+
+        foreach (explode('/', $rest) as $segment) {
+            if ($segment === '' || $segment === '.') {
+                continue;
+            }
+            if ($segment === '..') {
+                array_pop($segments);
+                continue;
+            }
+            $segments[] = $segment;
+        }
+
+        return $scheme . '://' . implode('/', $segments);
+    }
+}
\ No newline at end of file
@@ -16,11 +16,13 @@ class ProcessedBindings
      * @param array<FunctionSignature> $functions Processed function signatures
      * @param array<StructureDefinition> $structures Processed structure definitions
      * @param array<string, mixed> $constants Processed constants
+     * @param BindingIR|null $ir Binding IR the bindings were built from, null when assembled by hand
      */
     public function __construct(
         public readonly array $functions,
         public readonly array $structures,
-        public readonly array $constants
+        public readonly array $constants,
+        public readonly ?BindingIR $ir = null
     ) {
     }
 }
\ No newline at end of file
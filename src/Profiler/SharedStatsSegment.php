@@ -0,0 +1,147 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Profiler;
+
+/**
+ * Layout and reader of the shared memory segment holding cross-worker call statistics
+ *
+ * Instrumented Bootstrap classes generated with shared statistics write into
+ * a shmop segment laid out as a header followed by SHARDS shards of one
+ * fixed-size slot per C function, indexed by the function ID generated into
+ * the Bootstrap:
+ *
+ *     header: magic (4 bytes) | version (uint32) | slot count (uint32) | slot size (uint32) | shard count (uint32)
+ *     shard:  slot count slots
+ *     slot:   name (NAME_SIZE bytes, NUL padded) | calls | total ns | max ns | BUCKETS histogram counters
+ *
+ * Each worker writes to shard pid % SHARDS and read() sums the shards. Slot
+ * names are only written to the first shard. Counters are unsigned 64-bit
+ * little-endian. Histogram bucket 0 counts calls faster than BUCKET_BASE_NS,
+ * bucket i > 0 counts calls below BUCKET_BASE_NS * 2^i, the last bucket
+ * everything slower.
+ *
+ * Counters are updated by unlocked read-modify-write cycles. Spreading the
+ * workers over shards limits lost increments to workers of the same shard
+ * recording the same function at the same moment, e.g. 4 workers per shard
+ * with 64 PHP-FPM workers; the totals are a lower bound.
+ */
+class SharedStatsSegment
+{
+    public const MAGIC = 'FFIS';
+    public const VERSION = 2;
+    public const HEADER_SIZE = 20;
+    public const SHARDS = 16;
+    public const NAME_SIZE = 64;
+    public const BUCKETS = 16;
+    public const BUCKET_BASE_NS = 256;
+    public const SLOT_SIZE = self::NAME_SIZE + 8 * (3 + self::BUCKETS);
+
+    /**
+     * Derive the System V IPC key used by the wrappers of a namespace
+     *
+     * @param string $namespace Base namespace of the generated wrappers
+     * @return int Positive shmop key
+     */
+    public static function keyFor(string $namespace): int
+    {
+        return crc32('c-to-php-ffi:' . trim($namespace, '\\')) & 0x7fffffff;
+    }
+
+    /**
+     * Get the exclusive upper latency bound of a histogram bucket
+     *
+     * @param int $bucket Bucket index
+     * @return int|null Bound in nanoseconds, null for the open-ended last bucket
+     */
+    public static function getBucketUpperBoundNs(int $bucket): ?int
+    {
+        return $bucket < self::BUCKETS - 1 ? self::BUCKET_BASE_NS << $bucket : null;
+    }
+
+    /**
+     * Read the statistics of every function that was called at least once
+     *
+     * The shards of all workers are summed, the maximum is the largest of any shard.
+     *
+     * @param int $key shmop key of the segment
+     * @return array<array{function: string, calls: int, totalNs: int, maxNs: int, histogram: array<int>}>|null Statistics, null if no valid segment exists
+     */
+    public static function read(int $key): ?array
+    {
+        if (!function_exists('shmop_open')) {
+            throw new \RuntimeException('The shmop extension is required to read shared call statistics');
+        }
+
+        $segment = @shmop_open($key, 'a', 0, 0);
+        if ($segment === false) {
+            return null;
+        }
+
+        $header = unpack('a4magic/Vversion/Vslots/VslotSize/Vshards', shmop_read($segment, 0, self::HEADER_SIZE));
+        if ($header['magic'] !== self::MAGIC
+            || $header['version'] !== self::VERSION
+            || $header['slotSize'] !== self::SLOT_SIZE
+            || $header['shards'] < 1
+            || shmop_size($segment) < self::HEADER_SIZE + $header['shards'] * $header['slots'] * self::SLOT_SIZE) {
+            return null;
+        }
+
+        $format = 'a' . self::NAME_SIZE . 'name/Pcalls/PtotalNs/PmaxNs/P' . self::BUCKETS . 'bucket';
+        $stats = [];
+
+        for ($id = 0; $id < $header['slots']; $id++) {
+            $stat = null;
+
+            for ($shard = 0; $shard < $header['shards']; $shard++) {
+                $offset = self::HEADER_SIZE + ($shard * $header['slots'] + $id) * self::SLOT_SIZE;
+                $slot = unpack($format, shmop_read($segment, $offset, self::SLOT_SIZE));
+
+                $stat ??= [
+                    'function' => rtrim($slot['name'], "\0"),
+                    'calls' => 0,
+                    'totalNs' => 0,
+                    'maxNs' => 0,
+                    'histogram' => array_fill(0, self::BUCKETS, 0),
+                ];
+
+                $stat['calls'] += $slot['calls'];
+                $stat['totalNs'] += $slot['totalNs'];
+                $stat['maxNs'] = max($stat['maxNs'], $slot['maxNs']);
+
+                for ($bucket = 0; $bucket < self::BUCKETS; $bucket++) {
+                    $stat['histogram'][$bucket] += $slot['bucket' . ($bucket + 1)];
+                }
+            }
+
+            if ($stat['calls'] > 0) {
+                $stats[] = $stat;
+            }
+        }
+
+        return $stats;
+    }
+
+    /**
+     * Estimate a latency percentile from a histogram
+     *
+     * @param array<int> $histogram Bucket counters
+     * @param float $percentile Percentile between 0 and 100
+     * @return int|null Upper bound of the bucket holding the percentile, null if it is the last bucket
+     */
+    public static function percentile(array $histogram, float $percentile): ?int
+    {
+        $threshold = array_sum($histogram) * $percentile / 100;
+        $seen = 0;
+
+        foreach ($histogram as $bucket => $count) {
+            $seen += $count;
+            if ($seen >= $threshold) {
+                return self::getBucketUpperBoundNs($bucket);
+            }
+        }
+
+        return null;
+    }
+}
\ No newline at end of file
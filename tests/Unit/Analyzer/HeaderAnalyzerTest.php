@@ -0,0 +1,127 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Analyzer;
+
+use Yangweijie\CWrapper\Analyzer\AnalysisResult;
+use Yangweijie\CWrapper\Analyzer\FunctionSignature;
+use Yangweijie\CWrapper\Analyzer\HeaderAnalyzer;
+use Yangweijie\CWrapper\Analyzer\HeaderLexer;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class HeaderAnalyzerTest extends FilesystemTestCase
+{
+    private const HEADER = <<<'C'
+        #ifndef DEMO_H
+        #define DEMO_H
+
+        #include "demo_types.h"
+
+        #define DEMO_VERSION 3
+        #define DEMO_NAME "demo"
+
+        #ifdef __cplusplus
+        extern "C" {
+        #endif
+
+        DEMO_API int demo_divmod(int a, int b, int *quotient, int * remainder) __attribute__((nonnull(3, 4)));
+        __attribute__((visibility("default"))) const char **demo_names(void);
+        extern void demo_each(void (*callback)(int value, void *data), void *data);
+
+        static inline int demo_twice(int v) { return v * 2; }
+
+        typedef struct demo_point_s {
+            double x;
+            double y;
+            char *label;
+        } demo_point;
+
+        typedef struct {
+            int id;
+        } demo_handle;
+
+        #ifdef __cplusplus
+        }
+        #endif
+
+        #endif
+        C;
+
+    private function analyze(): AnalysisResult
+    {
+        return (new HeaderAnalyzer(new HeaderLexer(16)))->analyze($this->createFile('demo.h', self::HEADER));
+    }
+
+    /**
+     * @return array<string, FunctionSignature>
+     */
+    private function functions(AnalysisResult $result): array
+    {
+        return array_column(array_map(fn($function) => [$function->name, $function], $result->functions), 1, 0);
+    }
+
+    public function testDeclarationsInsideExternCBlocksAreFound(): void
+    {
+        $functions = $this->functions($this->analyze());
+
+        // The inline definition has a body and is no declaration to bind
+        $this->assertSame(['demo_divmod', 'demo_names', 'demo_each'], array_keys($functions));
+    }
+
+    public function testAttributesAndExportMacrosAreStripped(): void
+    {
+        $functions = $this->functions($this->analyze());
+
+        $this->assertSame('int', $functions['demo_divmod']->returnType);
+        $this->assertSame('const char **', $functions['demo_names']->returnType);
+        $this->assertSame([], $functions['demo_names']->parameters);
+        $this->assertSame('void', $functions['demo_each']->returnType);
+    }
+
+    public function testPointerParametersKeepTheirNames(): void
+    {
+        $functions = $this->functions($this->analyze());
+
+        $this->assertSame([
+            ['name' => 'a', 'type' => 'int'],
+            ['name' => 'b', 'type' => 'int'],
+            ['name' => 'quotient', 'type' => 'int *'],
+            ['name' => 'remainder', 'type' => 'int *'],
+        ], $functions['demo_divmod']->parameters);
+
+        $this->assertSame([
+            ['name' => 'callback', 'type' => 'void (*callback)(int value, void *data)'],
+            ['name' => 'data', 'type' => 'void *'],
+        ], $functions['demo_each']->parameters);
+    }
+
+    public function testTypedefStructuresKeepTagAndTypedefName(): void
+    {
+        $structures = $this->analyze()->structures;
+
+        $this->assertCount(2, $structures);
+
+        $this->assertSame('demo_point', $structures[0]->name);
+        $this->assertSame('demo_point_s', $structures[0]->tag);
+        $this->assertSame('demo_point', $structures[0]->cType);
+        $this->assertSame([
+            ['name' => 'x', 'type' => 'double'],
+            ['name' => 'y', 'type' => 'double'],
+            ['name' => 'label', 'type' => 'char *'],
+        ], $structures[0]->fields);
+
+        $this->assertSame('demo_handle', $structures[1]->name);
+        $this->assertNull($structures[1]->tag);
+        $this->assertSame('demo_handle', $structures[1]->cType);
+    }
+
+    public function testConstantsAndDependencies(): void
+    {
+        $result = $this->analyze();
+
+        // Header guards without a value are no constants
+        $this->assertSame(['DEMO_VERSION' => 3, 'DEMO_NAME' => 'demo'], $result->constants);
+        $this->assertSame(['demo_types.h'], $result->dependencies);
+    }
+}
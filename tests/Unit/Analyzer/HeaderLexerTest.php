@@ -0,0 +1,88 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Analyzer;
+
+use Yangweijie\CWrapper\Analyzer\HeaderLexer;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class HeaderLexerTest extends FilesystemTestCase
+{
+    private const SOURCE = "int a_very_long_identifier_spanning_several_chunks(const char *s, double x);\n"
+        . "/* a comment across\n   the chunk boundary */ unsigned long v = 0x1234; // trailing\n"
+        . "const char *text = \"a \\\"quoted\\\" string\";\n";
+
+    private const TEXTS = [
+        'int', 'a_very_long_identifier_spanning_several_chunks', '(', 'const', 'char', '*', 's', ',',
+        'double', 'x', ')', ';', 'unsigned', 'long', 'v', '=', '0x1234', ';',
+        'const', 'char', '*', 'text', '=', '"a \\"quoted\\" string"', ';',
+    ];
+
+    public function testTokensSplitAcrossChunkBoundariesAreJoined(): void
+    {
+        $path = $this->createFile('chunks.h', self::SOURCE);
+
+        // Every chunk size from the minimum up moves the boundaries over every token
+        for ($chunkSize = 16; $chunkSize <= 48; $chunkSize++) {
+            $tokens = iterator_to_array((new HeaderLexer($chunkSize))->tokenize($path), false);
+
+            $this->assertSame(self::TEXTS, array_column($tokens, 1), "Chunk size {$chunkSize}");
+        }
+    }
+
+    public function testStreamAndStringTokenizationAgree(): void
+    {
+        $path = $this->createFile('chunks.h', self::SOURCE);
+        $lexer = new HeaderLexer(16);
+
+        $this->assertSame(
+            iterator_to_array($lexer->tokenizeString(self::SOURCE), false),
+            iterator_to_array($lexer->tokenize($path), false)
+        );
+    }
+
+    public function testTokenKindsAndSpacing(): void
+    {
+        $tokens = iterator_to_array((new HeaderLexer())->tokenizeString('f(a/*c*/b, 1.5e+3, "s", \'c\')'), false);
+
+        $this->assertSame([
+            [HeaderLexer::IDENTIFIER, 'f', false],
+            [HeaderLexer::PUNCTUATOR, '(', false],
+            [HeaderLexer::IDENTIFIER, 'a', false],
+            [HeaderLexer::IDENTIFIER, 'b', true],
+            [HeaderLexer::PUNCTUATOR, ',', false],
+            [HeaderLexer::NUMBER, '1.5e+3', true],
+            [HeaderLexer::PUNCTUATOR, ',', false],
+            [HeaderLexer::STRING, '"s"', true],
+            [HeaderLexer::PUNCTUATOR, ',', false],
+            [HeaderLexer::STRING, "'c'", true],
+            [HeaderLexer::PUNCTUATOR, ')', false],
+        ], $tokens);
+    }
+
+    public function testDirectivesJoinContinuationLinesAndDropComments(): void
+    {
+        $source = "#define SUM \\\n    (1 + 2) /* note */\n"
+            . "#include <stdio.h> // system header\n"
+            . "#define SPAN 3 /* spans\n   lines */\n"
+            . "int x; # not a directive\n";
+
+        foreach ([new HeaderLexer(16), new HeaderLexer()] as $lexer) {
+            $tokens = iterator_to_array($lexer->tokenize($this->createFile('directives.h', $source)), false);
+
+            $this->assertSame([
+                [HeaderLexer::DIRECTIVE, 'define SUM (1 + 2)', true],
+                [HeaderLexer::DIRECTIVE, 'include <stdio.h>', true],
+                [HeaderLexer::DIRECTIVE, 'define SPAN 3', true],
+                [HeaderLexer::IDENTIFIER, 'int', true],
+                [HeaderLexer::IDENTIFIER, 'x', true],
+                [HeaderLexer::PUNCTUATOR, ';', false],
+                [HeaderLexer::PUNCTUATOR, '#', true],
+                [HeaderLexer::IDENTIFIER, 'not', true],
+                [HeaderLexer::IDENTIFIER, 'a', true],
+                [HeaderLexer::IDENTIFIER, 'directive', true],
+            ], $tokens);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Analyzer;
+
+use PHPUnit\Framework\TestCase;
+use Yangweijie\CWrapper\Analyzer\SourceFile;
+
+class SourceFileTest extends TestCase
+{
+    public function testIncludesSkipCommentsAndDisabledBlocks(): void
+    {
+        $content = <<<'C'
+            #include "live.h"
+            // #include "line_comment.h"
+            /* #include "block_comment.h" */
+            #if 0
+            #include "disabled.h"
+            #ifdef NESTED
+            #include "nested.h"
+            #endif
+            #else
+            #  include "else_branch.h"
+            #endif
+            #include <stdio.h>
+            C;
+
+        $this->assertSame(['live.h', 'else_branch.h', 'stdio.h'], (new SourceFile('/demo.h', $content))->getIncludes());
+    }
+
+    public function testLineIndex(): void
+    {
+        $file = new SourceFile('/demo.h', "int a;\nint b;\n");
+
+        $this->assertSame([0, 7, 14], $file->getLineIndex());
+        $this->assertSame(1, $file->getLineNumber(3));
+        $this->assertSame(2, $file->getLineNumber(7));
+    }
+}
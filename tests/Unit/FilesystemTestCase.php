@@ -0,0 +1,60 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit;
+
+use PHPUnit\Framework\TestCase;
+
+/**
+ * Test case working in a temporary directory removed after each test
+ */
+abstract class FilesystemTestCase extends TestCase
+{
+    protected string $directory;
+
+    protected function setUp(): void
+    {
+        $this->directory = sys_get_temp_dir() . '/c-to-php-ffi-test-' . bin2hex(random_bytes(6));
+        mkdir($this->directory, 0700);
+        $this->directory = (string) realpath($this->directory);
+    }
+
+    protected function tearDown(): void
+    {
+        $this->remove($this->directory);
+    }
+
+    /**
+     * Write a file below the temporary directory
+     *
+     * @param string $filename Path relative to the temporary directory
+     * @param string $content File content
+     * @return string Absolute path of the file
+     */
+    protected function createFile(string $filename, string $content): string
+    {
+        $path = $this->directory . '/' . $filename;
+
+        if (!is_dir(dirname($path))) {
+            mkdir(dirname($path), 0700, true);
+        }
+        file_put_contents($path, $content);
+
+        return $path;
+    }
+
+    private function remove(string $path): void
+    {
+        if (is_dir($path) && !is_link($path)) {
+            foreach (scandir($path) ?: [] as $entry) {
+                if ($entry !== '.' && $entry !== '..') {
+                    $this->remove($path . '/' . $entry);
+                }
+            }
+            rmdir($path);
+        } elseif (file_exists($path) || is_link($path)) {
+            unlink($path);
+        }
+    }
+}
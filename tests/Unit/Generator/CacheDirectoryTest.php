@@ -0,0 +1,39 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Generator;
+
+use Yangweijie\CWrapper\Generator\CacheDirectory;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class CacheDirectoryTest extends FilesystemTestCase
+{
+    public function testCreatesPrivateDirectories(): void
+    {
+        $directory = CacheDirectory::get($this->directory . '/cache', 'twig');
+
+        $this->assertSame($this->directory . '/cache' . DIRECTORY_SEPARATOR . 'twig', $directory);
+        $this->assertDirectoryExists($directory);
+
+        if (function_exists('posix_geteuid')) {
+            $this->assertSame(0700, fileperms($this->directory . '/cache') & 0777);
+            $this->assertSame(0700, fileperms($directory) & 0777);
+        }
+    }
+
+    public function testRestrictsExistingDirectories(): void
+    {
+        if (!function_exists('posix_geteuid')) {
+            $this->markTestSkipped('Modes are only checked on POSIX systems');
+        }
+
+        mkdir($this->directory . '/cache', 0755);
+        chmod($this->directory . '/cache', 0755);
+
+        CacheDirectory::get($this->directory . '/cache');
+        clearstatcache();
+
+        $this->assertSame(0700, fileperms($this->directory . '/cache') & 0777);
+    }
+}
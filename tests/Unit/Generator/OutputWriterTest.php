@@ -0,0 +1,54 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Generator;
+
+use Yangweijie\CWrapper\Generator\OutputWriter;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class OutputWriterTest extends FilesystemTestCase
+{
+    public function testWritesOnlyChangedContent(): void
+    {
+        $writer = new OutputWriter();
+        $path = $this->directory . '/nested/Demo.php';
+
+        $this->assertTrue($writer->write($path, "<?php\n"));
+        $this->assertSame("<?php\n", file_get_contents($path));
+
+        $this->assertFalse($writer->write($path, "<?php\n"));
+
+        $this->assertTrue($writer->write($path, "<?php\n// changed\n"));
+        $this->assertSame("<?php\n// changed\n", file_get_contents($path));
+    }
+
+    public function testLeavesNoTemporaryFiles(): void
+    {
+        $writer = new OutputWriter();
+        $writer->write($this->directory . '/Demo.php', 'first');
+        $writer->write($this->directory . '/Demo.php', 'second');
+
+        $this->assertSame(['.', '..', 'Demo.php'], scandir($this->directory));
+    }
+
+    public function testPruneRemovesOnlyPreviousOutputs(): void
+    {
+        $this->createFile('output/Kept.php', 'kept');
+        $this->createFile('output/Stale.php', 'stale');
+        $this->createFile('output/Manual.php', 'added by hand');
+        $outside = $this->createFile('outside/Escape.php', 'outside');
+
+        $removed = (new OutputWriter())->prune(
+            $this->directory . '/output',
+            ['Kept.php', 'Stale.php', 'Missing.php', '../outside/Escape.php'],
+            ['Kept.php']
+        );
+
+        $this->assertSame(['Stale.php'], $removed);
+        $this->assertFileExists($this->directory . '/output/Kept.php');
+        $this->assertFileDoesNotExist($this->directory . '/output/Stale.php');
+        $this->assertFileExists($this->directory . '/output/Manual.php');
+        $this->assertFileExists($outside);
+    }
+}
@@ -0,0 +1,59 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Generator;
+
+use PHPUnit\Framework\Attributes\DataProvider;
+use PHPUnit\Framework\TestCase;
+use Yangweijie\CWrapper\Generator\TypeMapper;
+
+class TypeMapperTest extends TestCase
+{
+    /**
+     * @return array<array{string, string|null}>
+     */
+    public static function outPointerTypes(): array
+    {
+        return [
+            ['int *', 'int'],
+            ['double*', 'double'],
+            ['unsigned long  *', 'unsigned long'],
+            ['bool *', 'bool'],
+            ['size_t *', 'size_t'],
+            ['const int *', null],
+            ['char *', null],
+            ['unsigned char *', null],
+            ['int **', null],
+            ['void *', null],
+            ['demo_point *', null],
+            ['int', null],
+        ];
+    }
+
+    #[DataProvider('outPointerTypes')]
+    public function testGetOutPointerType(string $cType, ?string $expected): void
+    {
+        $this->assertSame($expected, (new TypeMapper())->getOutPointerType($cType));
+    }
+
+    /**
+     * @return array<array{string, string|null}>
+     */
+    public static function callbackTypes(): array
+    {
+        return [
+            ['void (*callback)(int value, void *data)', 'void (*)(int value, void *data)'],
+            ['int (*)(const char *)', 'int (*)(const char *)'],
+            ["void ( * on_click )(uiButton *sender,\n    void *data)", 'void (*)(uiButton *sender, void *data)'],
+            ['void *', null],
+            ['int', null],
+        ];
+    }
+
+    #[DataProvider('callbackTypes')]
+    public function testGetCallbackType(string $cType, ?string $expected): void
+    {
+        $this->assertSame($expected, (new TypeMapper())->getCallbackType($cType));
+    }
+}
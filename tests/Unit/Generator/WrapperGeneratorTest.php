@@ -0,0 +1,41 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Generator;
+
+use PHPUnit\Framework\TestCase;
+use Yangweijie\CWrapper\Generator\WrapperGenerator;
+
+class WrapperGeneratorTest extends TestCase
+{
+    /**
+     * @param array<string|int, int> $groupSizes
+     * @return array<array<string>>
+     */
+    private function partition(array $groupSizes, int $jobs): array
+    {
+        $method = new \ReflectionMethod(WrapperGenerator::class, 'partitionFunctionGroups');
+        $generator = (new \ReflectionClass(WrapperGenerator::class))->newInstanceWithoutConstructor();
+
+        return $method->invoke($generator, $groupSizes, $jobs);
+    }
+
+    public function testPartitionPlacesHeaviestGroupsOnLightestWorker(): void
+    {
+        $this->assertSame(
+            [['A', 'D'], ['B', 'C', 'E']],
+            $this->partition(['E' => 1, 'C' => 5, 'A' => 10, 'D' => 3, 'B' => 7], 2)
+        );
+    }
+
+    public function testPartitionNeverCreatesEmptyWorkers(): void
+    {
+        $this->assertSame([['B'], ['A']], $this->partition(['A' => 1, 'B' => 2], 4));
+    }
+
+    public function testPartitionKeepsNumericGroupNamesAsStrings(): void
+    {
+        $this->assertSame([['2024'], ['Functions']], $this->partition(['Functions' => 1, '2024' => 3], 2));
+    }
+}
@@ -0,0 +1,100 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Integration;
+
+use Yangweijie\CWrapper\Integration\FFIGenOutputMerger;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class FFIGenOutputMergerTest extends FilesystemTestCase
+{
+    private const METHODS_A = <<<'PHP'
+        <?php
+
+        namespace Demo;
+
+        trait Methods
+        {
+            /**
+             * @return int
+             */
+            public static function first(): int
+            {
+                return static::$ffi->first();
+            }
+        }
+        PHP;
+
+    private const METHODS_B = <<<'PHP'
+        <?php
+
+        namespace Demo;
+
+        trait Methods
+        {
+            public static function second(int $value): int
+            {
+                return static::$ffi->second($value);
+            }
+
+            public static function first(): int
+            {
+                return 0;
+            }
+        }
+        PHP;
+
+    public function testConstantsKeepDocCommentsAndFirstDeclaration(): void
+    {
+        $first = $this->createFile('a/constants.php', "<?php\n\nnamespace Demo;\n\nconst FIRST = 1;\n");
+        $second = $this->createFile(
+            'b/constants.php',
+            "<?php\n\nnamespace Demo;\n\n/**\n * Second constant\n */\nconst SECOND = 2;\nconst FIRST = 3;\n"
+        );
+
+        $this->assertSame(
+            "<?php\n\nnamespace Demo;\n\nconst FIRST = 1;\n/**\n * Second constant\n */\nconst SECOND = 2;\n",
+            (new FFIGenOutputMerger())->mergeConstants([$first, $second, $this->directory . '/missing.php'])
+        );
+    }
+
+    public function testMethodsAreMergedOncePerName(): void
+    {
+        $merged = (new FFIGenOutputMerger())->mergeMethods([
+            $this->createFile('a/Methods.php', self::METHODS_A),
+            $this->createFile('b/Methods.php', self::METHODS_B),
+        ]);
+
+        $this->assertStringStartsWith("<?php\n\nnamespace Demo;\n\ntrait Methods\n{\n    /**\n     * @return int\n     */\n", $merged);
+        $this->assertSame(1, substr_count($merged, 'function first('));
+        $this->assertStringContainsString('return static::$ffi->first();', $merged);
+        $this->assertStringNotContainsString('return 0;', $merged);
+        $this->assertLessThan(strpos($merged, 'function second('), strpos($merged, 'function first('));
+        $this->assertStringEndsWith("        return static::\$ffi->second(\$value);\n    }\n}\n", $merged);
+    }
+
+    public function testMergeWritesMergedAndCopiedFiles(): void
+    {
+        $this->createFile('a/constants.php', "<?php\n\nconst FIRST = 1;\n");
+        $this->createFile('a/Methods.php', self::METHODS_A);
+        $this->createFile('b/constants.php', "<?php\n\nconst SECOND = 2;\n");
+        $this->createFile('b/Methods.php', self::METHODS_B);
+        $this->createFile('b/types.php', "<?php\n// types\n");
+
+        $merger = new FFIGenOutputMerger();
+        $merger->merge([$this->directory . '/a', $this->directory . '/b'], $this->directory . '/out');
+
+        $this->assertSame("<?php\n\nconst FIRST = 1;\nconst SECOND = 2;\n", file_get_contents($this->directory . '/out/constants.php'));
+        $this->assertFileExists($this->directory . '/out/Methods.php');
+        $this->assertSame("<?php\n// types\n", file_get_contents($this->directory . '/out/types.php'));
+
+        // Unchanged outputs are not rewritten
+        touch($this->directory . '/out/types.php', 1000000000);
+        clearstatcache();
+        $merger->merge([$this->directory . '/a', $this->directory . '/b'], $this->directory . '/out');
+        clearstatcache();
+
+        $this->assertSame(1000000000, filemtime($this->directory . '/out/types.php'));
+    }
+}
@@ -0,0 +1,54 @@
+<?php
+
+declare(strict_types=1);
+
+namespace Yangweijie\CWrapper\Tests\Unit\Integration;
+
+use Yangweijie\CWrapper\Analyzer\DependencyResolver;
+use Yangweijie\CWrapper\Analyzer\IncludeCache;
+use Yangweijie\CWrapper\Integration\HeaderSharder;
+use Yangweijie\CWrapper\Tests\Unit\FilesystemTestCase;
+
+class HeaderSharderTest extends FilesystemTestCase
+{
+    private function sharder(): HeaderSharder
+    {
+        return new HeaderSharder(new DependencyResolver([], new IncludeCache('')));
+    }
+
+    public function testHeadersSharingAProjectHeaderStayTogether(): void
+    {
+        $this->createFile('common.h', "typedef int demo_id;\n");
+        $a = $this->createFile('a.h', "#include \"common.h\"\nvoid a(demo_id id);\n");
+        $b = $this->createFile('b.h', "#include \"common.h\"\nvoid b(demo_id id);\n");
+        $c = $this->createFile('c.h', "void c(void);\n");
+
+        $shards = $this->sharder()->partition([$a, $b, $c], 4);
+
+        $this->assertCount(2, $shards);
+        $this->assertEqualsCanonicalizing([$a, $b], $shards[0]);
+        $this->assertSame([$c], $shards[1]);
+    }
+
+    public function testIncludedHeadersJoinTheirIncluder(): void
+    {
+        $base = $this->createFile('base.h', "typedef int demo_id;\n");
+        $derived = $this->createFile('derived.h', "#include \"base.h\"\nvoid derived(demo_id id);\n");
+        $other = $this->createFile('other.h', "void other(void);\n");
+
+        $shards = $this->sharder()->partition([$derived, $base, $other], 2);
+
+        // The included header comes first in compilation order
+        $this->assertSame([[$base, $derived], [$other]], $shards);
+    }
+
+    public function testSingleShardAndMissingHeadersAreLeftUnchanged(): void
+    {
+        $a = $this->createFile('a.h', "void a(void);\n");
+        $b = $this->createFile('b.h', "void b(void);\n");
+        $missing = $this->directory . '/missing.h';
+
+        $this->assertSame([[$a, $b]], $this->sharder()->partition([$a, $b], 1));
+        $this->assertSame([[$a, $b, $missing]], $this->sharder()->partition([$a, $b, $missing], 4));
+    }
+}